@@ -0,0 +1,314 @@
+/*
+Round-trip tests for the on-disk formats. Builds tournmant.cpp with its
+main() compiled out and drives the writers and readers directly; exits
+non-zero if any check fails.
+*/
+#define TOURNAMENT_NO_MAIN
+#include "../tournmant.cpp"
+
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+static int failures = 0;
+
+#define CHECK(cond)                                                                       \
+    do {                                                                                  \
+        if (!(cond)) {                                                                    \
+            cerr << __FILE__ << ":" << __LINE__ << ": check failed: " << #cond << endl;   \
+            failures++;                                                                   \
+        }                                                                                 \
+    } while (0)
+
+static vector<char> readFile(const fs::path& path) {
+    ifstream in(path, ios::binary);
+    return vector<char>((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+}
+
+// Flip one bit of a file in place
+static void corrupt(const fs::path& path, size_t offset) {
+    fstream f(path, ios::in | ios::out | ios::binary);
+    f.seekg((streamoff)offset);
+    char c = 0;
+    f.get(c);
+    f.seekp((streamoff)offset);
+    f.put((char)(c ^ 1));
+}
+
+// Three matches, the middle one spanning a block boundary; every event reads
+// back unchanged and every block passes its checksum until a bit is flipped
+static void testBallLog(const fs::path& dir) {
+    fs::path path = dir / "balls.log";
+    const uint32_t sizes[] = {10, BallLog::BLOCK_EVENTS + 5, 1};
+    vector<BallEvent> written;
+
+    BallLog log;
+    CHECK(log.open(path.string()));
+    for (uint32_t m = 0; m < 3; m++) {
+        log.beginMatch(100 + m);
+        for (uint32_t i = 0; i < sizes[m]; i++) {
+            BallEvent e = {100 + m, i % 5, 5 + i % 5, (uint8_t)(i & 1), (uint8_t)(i % 12), (uint8_t)(i % 7), 0};
+            log.append(e);
+            written.push_back(e);
+        }
+    }
+    CHECK(log.close());
+
+    {
+        MappedBallLog mapped;
+        CHECK(mapped.open(path.string()));
+        CHECK(mapped.getEventCount() == written.size());
+        CHECK(mapped.getMatchCount() == 3);
+        uint64_t first = 0;
+        for (uint32_t m = 0; m < 3 && m < mapped.getMatchCount(); m++) {
+            const MatchIndexEntry& entry = mapped.getMatch(m);
+            CHECK(entry.matchId == 100 + m);
+            CHECK(entry.eventCount == sizes[m]);
+            CHECK(entry.firstEvent == first);
+            first += sizes[m];
+        }
+        CHECK(mapped.getBlockCount() == 2);
+        for (uint64_t b = 0; b < mapped.getBlockCount(); b++) CHECK(mapped.verifyBlock(b));
+
+        size_t mismatches = 0;
+        for (uint64_t n = 0; n < mapped.getEventCount() && n < written.size(); n++) {
+            mismatches += memcmp(&mapped.event(n), &written[n], sizeof(BallEvent)) != 0;
+        }
+        CHECK(mismatches == 0);
+
+        uint64_t visited = 0;
+        mapped.forEachEvent([&](const BallEvent& e) { visited += e.matchId >= 100; });
+        CHECK(visited == written.size());
+    }
+
+    corrupt(path, sizeof(LogFileHeader) + sizeof(LogBlockHeader) + 3);
+    MappedBallLog mapped;
+    CHECK(mapped.open(path.string()));
+    CHECK(!mapped.verifyBlock(0));
+    CHECK(mapped.verifyBlock(1));
+}
+
+// Overwrite a field of a file in place
+template <typename T>
+static void patch(const fs::path& path, size_t offset, T value) {
+    fstream f(path, ios::in | ios::out | ios::binary);
+    f.seekp((streamoff)offset);
+    f.write((const char*)&value, sizeof(value));
+}
+
+// Headers that disagree with the file are rejected on open, and a block
+// header claiming more events than the block holds is clamped
+static void testCorruptBallLog(const fs::path& dir) {
+    fs::path good = dir / "corrupt-source.log";
+    fs::path path = dir / "corrupt.log";
+    BallLog log;
+    CHECK(log.open(good.string()));
+    for (uint32_t m = 0; m < 2; m++) {
+        log.beginMatch(m);
+        for (uint32_t i = 0; i < BallLog::BLOCK_EVENTS - 3; i++) log.append(BallEvent{m, 0, 5, 0, 0, 0, 0});
+    }
+    CHECK(log.close());
+    uint64_t events = 2 * (BallLog::BLOCK_EVENTS - 3);
+    size_t trailer = fs::file_size(good) - sizeof(LogTrailer);
+    size_t index = trailer - 2 * sizeof(MatchIndexEntry);
+
+    auto opens = [&](auto&& damage) {
+        fs::copy_file(good, path, fs::copy_options::overwrite_existing);
+        damage();
+        MappedBallLog mapped;
+        return mapped.open(path.string());
+    };
+    CHECK(opens([] {}));
+    CHECK(!opens([&] { patch<uint32_t>(path, offsetof(LogFileHeader, blockEvents), 0); }));
+    CHECK(!opens([&] { patch<uint32_t>(path, offsetof(LogFileHeader, blockEvents), 1); }));
+    CHECK(!opens([&] { patch<uint64_t>(path, trailer + offsetof(LogTrailer, eventCount), events + 1); }));
+    CHECK(!opens([&] { patch<uint64_t>(path, trailer + offsetof(LogTrailer, eventCount), UINT64_MAX); }));
+    CHECK(!opens([&] { patch<uint64_t>(path, trailer + offsetof(LogTrailer, matchCount), UINT64_MAX / 8); }));
+    CHECK(!opens([&] { patch<uint64_t>(path, trailer + offsetof(LogTrailer, indexOffset), index - 16); }));
+    CHECK(!opens([&] { patch<uint32_t>(path, index + sizeof(MatchIndexEntry) + offsetof(MatchIndexEntry, eventCount), BallLog::BLOCK_EVENTS); }));
+    CHECK(!opens([&] { patch<uint64_t>(path, index + offsetof(MatchIndexEntry, firstEvent), UINT64_MAX); }));
+
+    size_t lastBlock = sizeof(LogFileHeader) + sizeof(LogBlockHeader) + BallLog::BLOCK_EVENTS * sizeof(BallEvent);
+    CHECK(opens([&] { patch<uint32_t>(path, lastBlock + offsetof(LogBlockHeader, eventCount), UINT32_MAX); }));
+    MappedBallLog mapped;
+    CHECK(mapped.open(path.string()));
+    CHECK(mapped.verifyBlock(0));
+    CHECK(!mapped.verifyBlock(1));
+    uint64_t visited = 0;
+    mapped.forEachEvent([&](const BallEvent&) { visited++; });
+    CHECK(visited == events);
+}
+
+// Enough innings to flush more than one chunk; the file scans to the same
+// totals as the words in memory
+static void testPackedArchive(const fs::path& dir) {
+    fs::path path = dir / "innings.arc";
+    mt19937 rng(7);
+    vector<uint64_t> words;
+
+    PackedArchive archive;
+    CHECK(archive.open(path.string()));
+    for (int m = 0; m < 40000; m++) {
+        uint64_t innings[2];
+        for (int i = 0; i < 2; i++) {
+            uint64_t word = PackedInnings::withTeams(PackedInnings::openers(0, 1, 3), (m + i) % 4, (m + i + 1) % 4);
+            int balls = 1 + (int)(rng() % PackedInnings::MAX_BALLS);
+            for (int b = 0; b < balls; b++) word = PackedInnings::appendBall(word, (BallOutcome)(rng() % 7));
+            innings[i] = word;
+            words.push_back(word);
+        }
+        archive.appendMatch(innings[0], innings[1]);
+    }
+    CHECK(archive.getInningsCount() == words.size());
+    CHECK(archive.close());
+    CHECK(fs::file_size(path) == sizeof(PackedArchiveHeader) + words.size() * sizeof(uint64_t));
+
+    ArchiveSummary expected, scanned;
+    PackedArchive::scan(words.data(), words.size(), expected);
+    CHECK(PackedArchive::scanFile(path.string(), scanned));
+    CHECK(scanned.innings == expected.innings);
+    CHECK(scanned.balls == expected.balls);
+    CHECK(scanned.runs == expected.runs);
+    CHECK(scanned.wickets == expected.wickets);
+    CHECK(scanned.fours == expected.fours);
+    CHECK(scanned.sixes == expected.sixes);
+    CHECK(scanned.highestScore == expected.highestScore);
+
+    // A truncated archive is reported, not scanned short
+    fs::resize_file(path, fs::file_size(path) - sizeof(uint64_t));
+    ArchiveSummary truncated;
+    CHECK(!PackedArchive::scanFile(path.string(), truncated));
+}
+
+static void startBatchTournament(Tournament& t, uint32_t seed) {
+    t.setInteractive(false);
+    t.setVerbose(false);
+    t.setSeed(seed);
+    t.createTeams();
+    t.createDefaultPlayers();
+    t.generateFixtures();
+}
+
+// A tournament restored mid-season saves the same bytes and finishes the
+// season exactly as the original does
+static void testCheckpoint(const fs::path& dir) {
+    fs::path first = dir / "round3.ckpt";
+    fs::path second = dir / "round3-again.ckpt";
+
+    Tournament original("Checkpoint Test");
+    startBatchTournament(original, 11);
+    for (int round = 0; round < 3; round++) original.playRound();
+    CHECK(original.saveCheckpoint(first.string()));
+
+    Tournament restored("Unnamed");
+    restored.setVerbose(false);
+    CHECK(restored.loadCheckpoint(first.string()));
+    CHECK(restored.saveCheckpoint(second.string()));
+    CHECK(readFile(first) == readFile(second));
+
+    original.playTournament();
+    restored.playTournament();
+    CHECK(original.getMatchCount() == restored.getMatchCount());
+    for (size_t m = 0; m < original.getMatchCount() && m < restored.getMatchCount(); m++) {
+        const Match* a = original.getMatches()[m];
+        const Match* b = restored.getMatches()[m];
+        CHECK(a->getResult() == b->getResult());
+        CHECK(a->getFirstInnings().getTotalRuns() == b->getFirstInnings().getTotalRuns());
+        CHECK(a->getSecondInnings().getTotalRuns() == b->getSecondInnings().getTotalRuns());
+    }
+    for (size_t t = 0; t < original.getTeams().size() && t < restored.getTeams().size(); t++) {
+        CHECK(original.getTeams()[t]->getPoints() == restored.getTeams()[t]->getPoints());
+    }
+    for (size_t p = 0; p < original.getPlayers().size() && p < restored.getPlayers().size(); p++) {
+        CHECK(original.getPlayers()[p]->getTotalRunsScored() == restored.getPlayers()[p]->getTotalRunsScored());
+        CHECK(original.getPlayers()[p]->getTotalWicketsTaken() == restored.getPlayers()[p]->getTotalWicketsTaken());
+    }
+
+    corrupt(first, readFile(first).size() - 1);
+    Tournament rejected("Unnamed");
+    rejected.setVerbose(false);
+    CHECK(!rejected.loadCheckpoint(first.string()));
+}
+
+static void checkCareer(const CareerStore& store, const Player& player, int tournaments) {
+    CareerRecord record = {};
+    CHECK(store.lookup(player.getName(), record));
+    CHECK(record.tournaments == tournaments);
+    CHECK(record.runs == tournaments * player.getTotalRunsScored());
+    CHECK(record.wickets == tournaments * player.getTotalWicketsTaken());
+}
+
+// Careers survive reopening, compaction and a torn log batch; names that
+// share their first 23 characters keep separate careers
+static void testCareerStore(const fs::path& dir) {
+    fs::path careers = dir / "careers";
+    fs::create_directories(careers);
+
+    vector<shared_ptr<Player>> players = {
+        make_shared<Batsman>("Opener", 25),
+        make_shared<Bowler>("Quick", 27),
+        make_shared<Batsman>("A player with a very long name, first", 30),
+        make_shared<Batsman>("A player with a very long name, second", 31),
+    };
+    for (size_t i = 0; i < players.size(); i++) {
+        players[i]->addRuns(10 + (int)i);
+        players[i]->addWicket();
+    }
+
+    {
+        CareerStore store;
+        CHECK(store.open(careers.string()));
+        CHECK(store.recordTournament(players));
+        CHECK(store.recordTournament(players));
+    }
+    {
+        CareerStore store;
+        CHECK(store.open(careers.string()));
+        CHECK(store.size() == players.size());
+        for (const auto& p : players) checkCareer(store, *p, 2);
+        CHECK(store.compact());
+    }
+    {
+        CareerStore store;
+        CHECK(store.open(careers.string()));
+        CHECK(store.verifySnapshot());
+        CHECK(store.size() == players.size());
+        for (const auto& p : players) checkCareer(store, *p, 2);
+        CHECK(store.recordTournament(players));
+    }
+
+    // A tournament cut short in the log is dropped whole on open, not just
+    // its torn record
+    {
+        CareerStore store;
+        CHECK(store.open(careers.string()));
+        CHECK(store.recordTournament(players));
+        for (const auto& p : players) checkCareer(store, *p, 4);
+    }
+    fs::resize_file(careers / "careers.log", fs::file_size(careers / "careers.log") - sizeof(CareerRecord) * 3 / 2);
+    CareerStore store;
+    CHECK(store.open(careers.string()));
+    for (const auto& p : players) checkCareer(store, *p, 3);
+    CHECK(store.recordTournament(players));
+    for (const auto& p : players) checkCareer(store, *p, 4);
+}
+
+int main() {
+    fs::path dir = fs::temp_directory_path() / ("tournament-format-tests-" + to_string(chrono::steady_clock::now().time_since_epoch().count()));
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+
+    testBallLog(dir);
+    testCorruptBallLog(dir);
+    testPackedArchive(dir);
+    testCheckpoint(dir);
+    testCareerStore(dir);
+
+    fs::remove_all(dir);
+    if (failures) {
+        cerr << failures << " checks failed" << endl;
+        return 1;
+    }
+    cout << "All format round-trip checks passed" << endl;
+    return 0;
+}
@@ -20,9 +20,291 @@ IPL-like Tournament System - Simplified Version
 #include <chrono>
 #include <random>
 #include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <cstddef>
+#include <sstream>
+#include <type_traits>
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <cstdlib>
+#include <charconv>
+#include <system_error>
+#if defined(__cpp_impl_coroutine)
+#include <coroutine>
+#include <utility>
+#include <barrier>
+#endif
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#endif
+#if defined(__BMI2__) || defined(__SSSE3__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+#if defined(_WIN32)
+#include <windows.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#if defined(__linux__)
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
 
 using namespace std;
 
+// Runtime counters; build with -DTOURNAMENT_STATS=0 to compile them out
+#ifndef TOURNAMENT_STATS
+#define TOURNAMENT_STATS 1
+#endif
+
+enum class Counter : int {
+    BALLS,              // deliveries, including Monte Carlo forks
+    MATCHES,
+    INNINGS,
+    ALLOCATIONS,        // global operator new calls
+    RNG_DRAWS,
+    FORKS,              // Monte Carlo continuations
+    COMMENTARY_BYTES,
+    SETUP_NS,           // teams, players and fixtures
+    PLAY_NS,            // tournament matches
+    MONTE_CARLO_NS,     // what-if, scenario and live-odds simulation
+    EXPORT_NS,
+    COUNT
+};
+
+/*
+Per-thread counter blocks, one cache line apart so threads never share a
+line. Each thread owns a block and updates it with relaxed load/store (a
+plain add); reads sum every block. Blocks come from a fixed table so the
+allocation counter can be bumped from operator new without allocating.
+The last block is shared by every thread past MAX_THREADS - 1, so it is
+updated with fetch_add instead.
+*/
+class SimStats {
+private:
+    static const int MAX_THREADS = 256;
+    
+    struct alignas(64) Block {
+        atomic<uint64_t> values[(int)Counter::COUNT];
+    };
+    
+    static Block* blocks() {
+        static Block table[MAX_THREADS];
+        return table;
+    }
+    
+    static Block& local() {
+        static atomic<int> claimed(0);
+        thread_local Block* block = &blocks()[min(claimed.fetch_add(1, memory_order_relaxed), MAX_THREADS - 1)];
+        return *block;
+    }
+    
+    static bool shared(const Block& block) { return &block == &blocks()[MAX_THREADS - 1]; }
+    
+public:
+    static void add(Counter c, uint64_t n = 1) {
+#if TOURNAMENT_STATS
+        Block& block = local();
+        atomic<uint64_t>& value = block.values[(int)c];
+        if (shared(block)) value.fetch_add(n, memory_order_relaxed);
+        else value.store(value.load(memory_order_relaxed) + n, memory_order_relaxed);
+#else
+        (void)c;
+        (void)n;
+#endif
+    }
+    
+    static uint64_t read(Counter c) {
+        uint64_t total = 0;
+        for (int t = 0; t < MAX_THREADS; t++) total += blocks()[t].values[(int)c].load(memory_order_relaxed);
+        return total;
+    }
+    
+    static void print(ostream& out) {
+        static const char* names[] = {"Balls", "Matches", "Innings", "Allocations", "RNG draws", "Forks",
+                                      "Commentary bytes", "Setup ms", "Play ms", "Monte Carlo ms", "Export ms"};
+        static_assert(sizeof(names) / sizeof(names[0]) == (size_t)Counter::COUNT, "counter names");
+        
+        out << "\n=== RUNTIME COUNTERS ===" << endl;
+#if TOURNAMENT_STATS
+        for (int c = 0; c < (int)Counter::COUNT; c++) {
+            uint64_t value = read((Counter)c);
+            out << setw(20) << names[c] << "  ";
+            if (c >= (int)Counter::SETUP_NS) out << fixed << setprecision(3) << value / 1e6 << endl;
+            else out << value << endl;
+        }
+#else
+        out << "(compiled out: TOURNAMENT_STATS=0)" << endl;
+#endif
+    }
+};
+
+// Adds the lifetime of the scope to a time counter
+class PhaseTimer {
+private:
+    Counter counter;
+    chrono::steady_clock::time_point start;
+    
+public:
+    explicit PhaseTimer(Counter c) : counter(c), start(chrono::steady_clock::now()) {}
+    ~PhaseTimer() {
+        SimStats::add(counter, (uint64_t)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count());
+    }
+};
+
+#if TOURNAMENT_STATS
+void* operator new(size_t size) {
+    SimStats::add(Counter::ALLOCATIONS);
+    if (void* p = malloc(size ? size : 1)) return p;
+    throw bad_alloc();
+}
+
+// Out of line so the compiler does not pair new with free at call sites
+#if defined(__GNUC__)
+__attribute__((noinline))
+#endif
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { ::operator delete(p); }
+#endif
+
+/*
+Chrome trace spans, loadable in Perfetto or chrome://tracing. Each thread
+appends complete ("X") events to its own buffer; the tracer owns the buffers
+and writes one JSON file at exit. A span costs one relaxed load while
+tracing is off.
+*/
+class Tracer {
+private:
+    struct Event {
+        const char* name;       // string literal
+        const char* argName;    // optional
+        int64_t arg;
+        uint64_t start;         // ns since start()
+        uint64_t duration;
+    };
+    
+    struct ThreadBuffer {
+        uint32_t tid;
+        bool main;
+        vector<Event> events;
+    };
+    
+    atomic<bool> on;
+    mutex lock;
+    vector<unique_ptr<ThreadBuffer>> buffers;
+    string path;
+    thread::id mainThread;
+    chrono::steady_clock::time_point origin;
+    
+    Tracer() : on(false) {}
+    
+    static Tracer& instance() {
+        static Tracer tracer;
+        return tracer;
+    }
+    
+    ThreadBuffer& local() {
+        thread_local ThreadBuffer* buffer = nullptr;
+        if (!buffer) {
+            lock_guard<mutex> guard(lock);
+            buffers.push_back(make_unique<ThreadBuffer>());
+            buffer = buffers.back().get();
+            buffer->tid = (uint32_t)buffers.size();
+            buffer->main = this_thread::get_id() == mainThread;
+            buffer->events.reserve(1 << 12);
+        }
+        return *buffer;
+    }
+    
+public:
+    static bool enabled() { return instance().on.load(memory_order_relaxed); }
+    
+    // Begin tracing; the file is written when the process exits
+    static void start(const string& file) {
+        Tracer& t = instance();
+        t.path = file;
+        t.mainThread = this_thread::get_id();
+        t.origin = chrono::steady_clock::now();
+        t.on.store(true, memory_order_relaxed);
+        atexit([] {
+            if (!flush()) cerr << "Cannot write trace " << instance().path << endl;
+        });
+    }
+    
+    static uint64_t now() {
+        return (uint64_t)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - instance().origin).count();
+    }
+    
+    static void record(const char* name, uint64_t start, uint64_t end, const char* argName, int64_t arg) {
+        instance().local().events.push_back({name, argName, arg, start, end - start});
+    }
+    
+    static bool flush() {
+        Tracer& t = instance();
+        t.on.store(false, memory_order_relaxed);
+        FILE* file = fopen(t.path.c_str(), "w");
+        if (!file) return false;
+        
+        lock_guard<mutex> guard(t.lock);
+        fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+        bool first = true;
+        for (const auto& buffer : t.buffers) {
+            fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s %u\"}}",
+                    first ? "" : ",\n", buffer->tid, buffer->main ? "main" : "worker", buffer->tid);
+            first = false;
+            for (const auto& e : buffer->events) {
+                fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f",
+                        e.name, buffer->tid, e.start / 1e3, e.duration / 1e3);
+                if (e.argName) fprintf(file, ",\"args\":{\"%s\":%lld}", e.argName, (long long)e.arg);
+                fputc('}', file);
+            }
+        }
+        fprintf(file, "\n]}\n");
+        return fclose(file) == 0;
+    }
+};
+
+// Records its scope as a trace span when tracing is on
+class TraceSpan {
+private:
+    const char* name;
+    const char* argName;
+    int64_t arg;
+    uint64_t start;
+    bool active;
+    
+public:
+    explicit TraceSpan(const char* n, const char* an = nullptr, int64_t a = 0) :
+        name(n), argName(an), arg(a), start(0), active(Tracer::enabled()) {
+        if (active) start = Tracer::now();
+    }
+    
+    ~TraceSpan() {
+        if (active) Tracer::record(name, start, Tracer::now(), argName, arg);
+    }
+    
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+};
+
 // Forward declarations
 class Player;
 class Team;
@@ -55,801 +337,6538 @@ enum class BallOutcome {
     WICKET
 };
 
-// Base Player class
-class Player {
-protected:
-    string name;
-    int age;
-    PlayerType type;
-    int totalCredits;
-    int matchCredits;
-    
-    // Persistent statistics
-    int totalRunsScored;
-    int totalBallsFaced;
-    int totalWicketsTaken;
-    int totalBallsBowled;
-    int totalRunsConceded;
-    
-public:
-    Player(const string& n, int a, PlayerType t) : name(n), age(a), type(t), 
-        totalCredits(0), matchCredits(0), totalRunsScored(0), totalBallsFaced(0),
-        totalWicketsTaken(0), totalBallsBowled(0), totalRunsConceded(0) {}
-    
-    virtual ~Player() = default;
-    
-    // Getters
-    string getName() const { return name; }
-    PlayerType getType() const { return type; }
-    int getTotalCredits() const { return totalCredits; }
-    int getMatchCredits() const { return matchCredits; }
-    
-    // Statistics getters
-    int getTotalRunsScored() const { return totalRunsScored; }
-    int getTotalBallsFaced() const { return totalBallsFaced; }
-    int getTotalWicketsTaken() const { return totalWicketsTaken; }
-    int getTotalBallsBowled() const { return totalBallsBowled; }
-    int getTotalRunsConceded() const { return totalRunsConceded; }
-    
-    // Virtual methods for different player types
-    virtual void updateCredits(int runs, int wickets) = 0;
-    virtual void resetMatchCredits() { matchCredits = 0; }
-    
-    // Utility methods
-    bool isBatsman() const { return type == PlayerType::BATSMAN || type == PlayerType::ALLROUNDER; }
-    bool isBowler() const { return type == PlayerType::BOWLER || type == PlayerType::ALLROUNDER; }
-    
-    // Statistics update methods
-    void addToTotalRuns(int runs) { totalRunsScored += runs; }
-    void addToTotalBallsFaced() { totalBallsFaced++; }
-    void addToTotalWickets(int wickets) { totalWicketsTaken += wickets; }
-    void addToTotalBallsBowled() { totalBallsBowled++; }
-    void addToTotalRunsConceded(int runs) { totalRunsConceded += runs; }
-    
-    // Virtual methods for derived classes
-    virtual void addWicket() { addToTotalWickets(1); }
-    virtual void addBall() { addToTotalBallsBowled(); }
-    virtual void addRuns(int runs) { addToTotalRuns(runs); }
+// Map the simulator's raw outcome value (0-6, where 5 = wicket) to a BallOutcome
+inline BallOutcome toBallOutcome(int outcome) {
+    switch (outcome) {
+        case 0: return BallOutcome::DOT_BALL;
+        case 1: return BallOutcome::SINGLE;
+        case 2: return BallOutcome::DOUBLE;
+        case 3: return BallOutcome::TRIPLE;
+        case 4: return BallOutcome::FOUR;
+        case 6: return BallOutcome::SIX;
+        default: return BallOutcome::WICKET;
+    }
+}
+
+// Inverse of toBallOutcome
+inline int toRawOutcome(BallOutcome outcome) {
+    switch (outcome) {
+        case BallOutcome::WICKET: return 5;
+        case BallOutcome::SIX: return 6;
+        default: return (int)outcome;
+    }
+}
+
+inline int runsFor(BallOutcome outcome) {
+    switch (outcome) {
+        case BallOutcome::SINGLE: return 1;
+        case BallOutcome::DOUBLE: return 2;
+        case BallOutcome::TRIPLE: return 3;
+        case BallOutcome::FOUR: return 4;
+        case BallOutcome::SIX: return 6;
+        default: return 0;
+    }
+}
+
+// Fixed-size binary record of one delivery (16 bytes, little-endian on disk)
+struct BallEvent {
+    uint32_t matchId;
+    uint32_t strikerId;
+    uint32_t bowlerId;
+    uint8_t innings;     // 0 = first innings, 1 = second innings
+    uint8_t ballIndex;   // 0-based delivery number within the innings
+    uint8_t outcome;     // BallOutcome
+    uint8_t reserved;
 };
+static_assert(sizeof(BallEvent) == 16, "BallEvent must stay 16 bytes");
 
-// Batsman class
-class Batsman : public Player {
+// CRC-32C used to checksum log blocks (hardware instruction when available,
+// otherwise slicing-by-8 tables)
+class Crc32c {
 private:
-    int runsScored;
-    int ballsFaced;
-    int fours;
-    int sixes;
+    struct Tables {
+        uint32_t v[8 * 256];
+    };
     
+    // Static storage, so the first checksum does not allocate
+    static const uint32_t* tables() {
+        static const Tables t = [] {
+            Tables tables;
+            uint32_t* v = tables.v;
+            for (uint32_t i = 0; i < 256; i++) {
+                uint32_t c = i;
+                for (int k = 0; k < 8; k++) c = (c >> 1) ^ (0x82F63B78u & (0u - (c & 1)));
+                v[i] = c;
+            }
+            for (uint32_t i = 0; i < 256; i++) {
+                for (int s = 1; s < 8; s++) {
+                    uint32_t prev = v[(s - 1) * 256 + i];
+                    v[s * 256 + i] = (prev >> 8) ^ v[prev & 0xFF];
+                }
+            }
+            return tables;
+        }();
+        return t.v;
+    }
+
 public:
-    Batsman(const string& name, int age) : Player(name, age, PlayerType::BATSMAN),
-        runsScored(0), ballsFaced(0), fours(0), sixes(0) {}
-    
-    void updateCredits(int runs, int wickets) override {
-        matchCredits += runs / 20;  // 20 runs = 1 credit
-        totalCredits += runs / 20;
+    static uint32_t compute(const void* data, size_t len, uint32_t crc = 0) {
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+        const uint32_t* t = tables();
+        crc = ~crc;
+        while (len >= 8) {
+            uint64_t v;
+            memcpy(&v, p, 8);
+#if defined(__SSE4_2__)
+            crc = (uint32_t)_mm_crc32_u64(crc, v);
+#else
+            v ^= crc;
+            crc = t[7 * 256 + (v & 0xFF)] ^ t[6 * 256 + ((v >> 8) & 0xFF)] ^
+                  t[5 * 256 + ((v >> 16) & 0xFF)] ^ t[4 * 256 + ((v >> 24) & 0xFF)] ^
+                  t[3 * 256 + ((v >> 32) & 0xFF)] ^ t[2 * 256 + ((v >> 40) & 0xFF)] ^
+                  t[1 * 256 + ((v >> 48) & 0xFF)] ^ t[(v >> 56) & 0xFF];
+#endif
+            p += 8;
+            len -= 8;
+        }
+        while (len--) crc = t[(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+        return ~crc;
     }
-    
-    void addRuns(int runs) {
-        runsScored += runs;
-        addToTotalRuns(runs);
-        updateCredits(runs, 0);
-        
-        if (runs == 4) fours++;
-        else if (runs == 6) sixes++;
+};
+
+/*
+Ball log file layout:
+  [LogFileHeader]
+  [LogBlockHeader][BLOCK_EVENTS x BallEvent] ... (only the last block may be short)
+  [MatchIndexEntry x matchCount]
+  [LogTrailer]
+Blocks have a fixed capacity, so event n always lives in block n / BLOCK_EVENTS.
+*/
+struct LogFileHeader {
+    char magic[8];        // "IPLBALL1"
+    uint32_t version;
+    uint32_t blockEvents;
+};
+
+struct LogBlockHeader {
+    uint32_t magic;       // 'BLK0'
+    uint32_t eventCount;
+    uint32_t checksum;    // CRC-32C of the event payload
+    uint32_t blockNumber;
+};
+
+struct MatchIndexEntry {
+    uint32_t matchId;
+    uint32_t eventCount;
+    uint64_t firstEvent;  // global event number of the match's first ball
+};
+
+struct LogTrailer {
+    uint64_t indexOffset;
+    uint64_t matchCount;
+    uint64_t eventCount;
+    char magic[8];        // "IPLBIDX1"
+};
+
+// Append-only writer for ball events. Events are copied into an in-memory block
+// and each full block is written with a single fwrite, so appending is a memcpy.
+class BallLog {
+public:
+    static const uint32_t BLOCK_EVENTS = 4096;
+    static const uint32_t BLOCK_MAGIC = 0x304B4C42;  // "BLK0"
+
+private:
+    FILE* file;
+    vector<BallEvent> block;
+    uint32_t blockCount;
+    uint64_t totalEvents;
+    uint64_t bytesWritten;
+    vector<MatchIndexEntry> matchIndex;
+    bool failed;  // sticky: set by any short write, reported by close()
+
+    void write(const void* data, size_t size, size_t count) {
+        if (count && fwrite(data, size, count, file) != count) failed = true;
     }
-    
-    void addBall() { 
-        ballsFaced++; 
-        addToTotalBallsFaced();
+
+    void flushBlock() {
+        if (block.empty()) return;
+        LogBlockHeader header;
+        header.magic = BLOCK_MAGIC;
+        header.eventCount = (uint32_t)block.size();
+        header.checksum = Crc32c::compute(block.data(), block.size() * sizeof(BallEvent));
+        header.blockNumber = blockCount++;
+        write(&header, sizeof(header), 1);
+        write(block.data(), sizeof(BallEvent), block.size());
+        bytesWritten += sizeof(header) + block.size() * sizeof(BallEvent);
+        block.clear();
     }
-    
-    void addBoundary(bool isSix) {
-        if (isSix) sixes++;
-        else fours++;
+
+public:
+    BallLog() : file(nullptr), blockCount(0), totalEvents(0), bytesWritten(0), failed(false) {
+        block.reserve(BLOCK_EVENTS);
     }
-    
-    // Getters
-    int getRunsScored() const { return runsScored; }
-    int getBallsFaced() const { return ballsFaced; }
-    double getStrikeRate() const {
-        return ballsFaced > 0 ? (double)runsScored * 100 / ballsFaced : 0.0;
+
+    ~BallLog() { close(); }
+
+    BallLog(const BallLog&) = delete;
+    BallLog& operator=(const BallLog&) = delete;
+
+    bool open(const string& path) {
+        file = fopen(path.c_str(), "wb");
+        if (!file) return false;
+
+        LogFileHeader header;
+        memcpy(header.magic, "IPLBALL1", 8);
+        header.version = 1;
+        header.blockEvents = BLOCK_EVENTS;
+        failed = false;
+        write(&header, sizeof(header), 1);
+        bytesWritten = sizeof(header);
+        return !failed;
     }
-    
-    void resetMatchStats() {
-        runsScored = 0;
-        ballsFaced = 0;
-        fours = 0;
-        sixes = 0;
-        resetMatchCredits();
+
+    bool isOpen() const { return file != nullptr; }
+
+    // Pre-size the match index so logging a match never grows it
+    void reserveMatches(size_t matches) { matchIndex.reserve(matches); }
+
+    void beginMatch(uint32_t matchId) {
+        matchIndex.push_back({matchId, 0, totalEvents});
+    }
+
+    void append(const BallEvent& event) {
+        block.push_back(event);
+        totalEvents++;
+        if (!matchIndex.empty()) matchIndex.back().eventCount++;
+        if (block.size() == BLOCK_EVENTS) flushBlock();
+    }
+
+    // Write the final partial block, the match index and the trailer.
+    // False if any write since open() failed.
+    bool close() {
+        if (!file) return !failed;
+        flushBlock();
+
+        LogTrailer trailer;
+        trailer.indexOffset = bytesWritten;
+        trailer.matchCount = matchIndex.size();
+        trailer.eventCount = totalEvents;
+        memcpy(trailer.magic, "IPLBIDX1", 8);
+        write(matchIndex.data(), sizeof(MatchIndexEntry), matchIndex.size());
+        write(&trailer, sizeof(trailer), 1);
+
+        if (ferror(file)) failed = true;
+        if (fclose(file) != 0) failed = true;
+        file = nullptr;
+        return !failed;
     }
+
+    uint64_t getTotalEvents() const { return totalEvents; }
+    size_t getMatchCount() const { return matchIndex.size(); }
 };
 
-// Bowler class
-class Bowler : public Player {
+// Read-only memory mapping of a whole file
+class MappedFile {
 private:
-    int wicketsTaken;
-    int runsConceded;
-    int ballsBowled;
-    int maidens;
-    
+    const uint8_t* base;
+    size_t length;
+#if defined(_WIN32)
+    HANDLE fileHandle;
+    HANDLE mappingHandle;
+#endif
+
 public:
-    Bowler(const string& name, int age) : Player(name, age, PlayerType::BOWLER),
-        wicketsTaken(0), runsConceded(0), ballsBowled(0), maidens(0) {}
-    
-    void updateCredits(int runs, int wickets) override {
-        matchCredits += wickets;  // 1 wicket = 1 credit
-        totalCredits += wickets;
+    MappedFile() : base(nullptr), length(0) {
+#if defined(_WIN32)
+        fileHandle = INVALID_HANDLE_VALUE;
+        mappingHandle = nullptr;
+#endif
     }
-    
-    void addWicket() { 
-        wicketsTaken++; 
-        addToTotalWickets(1);
-        updateCredits(0, 1);
+
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const string& path) {
+        close();
+#if defined(_WIN32)
+        fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                 OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (fileHandle == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(fileHandle, &size) || size.QuadPart == 0) { close(); return false; }
+        mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mappingHandle) { close(); return false; }
+        base = (const uint8_t*)MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+        length = (size_t)size.QuadPart;
+        if (!base) { close(); return false; }
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0) { ::close(fd); return false; }
+        void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) return false;
+        base = (const uint8_t*)p;
+        length = (size_t)st.st_size;
+#endif
+        return true;
     }
-    
-    void addRuns(int runs) { 
-        runsConceded += runs; 
-        addToTotalRunsConceded(runs);
+
+    void close() {
+#if defined(_WIN32)
+        if (base) UnmapViewOfFile(base);
+        if (mappingHandle) CloseHandle(mappingHandle);
+        if (fileHandle != INVALID_HANDLE_VALUE) CloseHandle(fileHandle);
+        mappingHandle = nullptr;
+        fileHandle = INVALID_HANDLE_VALUE;
+#else
+        if (base) munmap((void*)base, length);
+#endif
+        base = nullptr;
+        length = 0;
     }
-    
-    void addBall() { 
-        ballsBowled++; 
-        addToTotalBallsBowled();
+
+    const uint8_t* data() const { return base; }
+    size_t size() const { return length; }
+};
+
+// Append-only output through a growing shared mapping. The file is mapped a
+// window at a time and filled with memcpy, so a large output costs a few
+// mmap/fallocate calls instead of a write per line; close() trims it to the
+// bytes written. Windows falls back to large-block buffered stdio.
+class MappedAppendFile {
+private:
+    static constexpr size_t WINDOW = (size_t)64 << 20;
+    static constexpr size_t RESERVE = (size_t)4 << 20;
+    static constexpr size_t STDIO_BUFFER = (size_t)4 << 20;
+
+    uint64_t written;
+    bool failed;
+#if defined(_WIN32)
+    FILE* file;
+    vector<char> buffer;
+#else
+    int fd;
+    char* window;
+    size_t windowUsed;
+    uint64_t reserved;    // bytes of the file that may be stored through the mapping
+
+    // Windows are always filled before moving on, so each starts on a
+    // WINDOW boundary (page aligned, as mmap requires). The mapping may run
+    // past the end of the file; only reserved bytes are touched.
+    bool nextWindow() {
+        if (window) munmap(window, WINDOW);
+        window = nullptr;
+        windowUsed = 0;
+        void* p = mmap(nullptr, WINDOW, PROT_READ | PROT_WRITE, MAP_SHARED, fd, (off_t)written);
+        if (p == MAP_FAILED) return false;
+        window = (char*)p;
+        return true;
     }
-    
-    void addMaiden() { maidens++; }
-    
-    // Getters
-    int getWicketsTaken() const { return wicketsTaken; }
-    int getRunsConceded() const { return runsConceded; }
-    double getEconomyRate() const {
-        return ballsBowled > 0 ? (double)runsConceded * 6 / ballsBowled : 0.0;
+
+    // Extend the file within the current window. Stores into a sparse
+    // mapping raise SIGBUS when the disk fills, so on Linux the blocks are
+    // allocated first and a full disk fails here instead.
+    bool reserve() {
+        uint64_t windowEnd = written - windowUsed + WINDOW;
+#if defined(__linux__)
+        uint64_t end = min<uint64_t>(windowEnd, written + RESERVE);
+        if (posix_fallocate(fd, (off_t)written, (off_t)(end - written)) != 0) return false;
+#else
+        uint64_t end = windowEnd;
+        if (ftruncate(fd, (off_t)end) != 0) return false;
+#endif
+        reserved = end;
+        return true;
     }
-    double getAverage() const {
-        return wicketsTaken > 0 ? (double)runsConceded / wicketsTaken : 0.0;
+#endif
+
+public:
+    MappedAppendFile() : written(0), failed(false) {
+#if defined(_WIN32)
+        file = nullptr;
+#else
+        fd = -1;
+        window = nullptr;
+        windowUsed = 0;
+        reserved = 0;
+#endif
     }
-    
-    void resetMatchStats() {
-        wicketsTaken = 0;
-        runsConceded = 0;
-        ballsBowled = 0;
-        maidens = 0;
-        resetMatchCredits();
+
+    ~MappedAppendFile() { close(); }
+
+    MappedAppendFile(const MappedAppendFile&) = delete;
+    MappedAppendFile& operator=(const MappedAppendFile&) = delete;
+
+    bool open(const string& path) {
+        close();
+        written = 0;
+        failed = false;
+#if defined(_WIN32)
+        file = fopen(path.c_str(), "wb");
+        if (!file) return false;
+        buffer.resize(STDIO_BUFFER);
+        setvbuf(file, buffer.data(), _IOFBF, buffer.size());
+#else
+        fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) return false;
+        reserved = 0;
+#endif
+        return true;
+    }
+
+    bool append(const void* data, size_t n) {
+        if (failed) return false;
+#if defined(_WIN32)
+        if (fwrite(data, 1, n, file) != n) failed = true;
+        else written += n;
+#else
+        const char* p = (const char*)data;
+        while (n > 0) {
+            if ((!window || windowUsed == WINDOW) && !nextWindow()) {
+                failed = true;
+                break;
+            }
+            if (written == reserved && !reserve()) {
+                failed = true;
+                break;
+            }
+            size_t take = min({n, WINDOW - windowUsed, (size_t)(reserved - written)});
+            memcpy(window + windowUsed, p, take);
+            windowUsed += take;
+            written += take;
+            p += take;
+            n -= take;
+        }
+#endif
+        return !failed;
+    }
+
+    // False if any append or the final trim failed
+    bool close() {
+#if defined(_WIN32)
+        if (!file) return !failed;
+        if (fclose(file) != 0) failed = true;
+        file = nullptr;
+        buffer.clear();
+        buffer.shrink_to_fit();
+#else
+        if (fd < 0) return !failed;
+        if (window) munmap(window, WINDOW);
+        window = nullptr;
+        if (ftruncate(fd, (off_t)written) != 0) failed = true;
+        ::close(fd);
+        fd = -1;
+#endif
+        return !failed;
+    }
+
+    uint64_t size() const { return written; }
+};
+
+// Zero-copy view over a ball log written by BallLog
+class MappedBallLog {
+private:
+    MappedFile file;
+    uint32_t blockEvents;
+    uint64_t eventCount;
+    uint64_t matchCount;
+    const MatchIndexEntry* index;
+
+    size_t blockOffset(uint64_t block) const {
+        return sizeof(LogFileHeader) +
+               (size_t)block * (sizeof(LogBlockHeader) + (size_t)blockEvents * sizeof(BallEvent));
+    }
+
+    // Events the block holds: full blocks except possibly the last
+    uint32_t blockCapacity(uint64_t block) const {
+        return (uint32_t)min<uint64_t>(blockEvents, eventCount - block * blockEvents);
+    }
+
+public:
+    MappedBallLog() : blockEvents(0), eventCount(0), matchCount(0), index(nullptr) {}
+
+    bool open(const string& path) {
+        if (!file.open(path)) return false;
+        if (file.size() < sizeof(LogFileHeader) + sizeof(LogTrailer)) return false;
+
+        const LogFileHeader* header = (const LogFileHeader*)file.data();
+        const LogTrailer* trailer = (const LogTrailer*)(file.data() + file.size() - sizeof(LogTrailer));
+        if (memcmp(header->magic, "IPLBALL1", 8) != 0 || memcmp(trailer->magic, "IPLBIDX1", 8) != 0) {
+            return false;
+        }
+        if (header->blockEvents == 0 || trailer->eventCount > file.size() / sizeof(BallEvent)) return false;
+        size_t indexBytes = file.size() - sizeof(LogTrailer);
+        if (trailer->matchCount > indexBytes / sizeof(MatchIndexEntry) ||
+            trailer->indexOffset != indexBytes - trailer->matchCount * sizeof(MatchIndexEntry)) {
+            return false;
+        }
+
+        blockEvents = header->blockEvents;
+        eventCount = trailer->eventCount;
+        matchCount = trailer->matchCount;
+        index = (const MatchIndexEntry*)(file.data() + trailer->indexOffset);
+
+        // The blocks must end exactly where the index starts (the last one
+        // may be partial), and every match must lie inside the logged events
+        uint64_t fullBlocks = eventCount / blockEvents;
+        uint32_t tail = (uint32_t)(eventCount % blockEvents);
+        size_t blocksEnd = blockOffset(fullBlocks) + (tail ? sizeof(LogBlockHeader) + tail * sizeof(BallEvent) : 0);
+        if (blocksEnd != trailer->indexOffset) return false;
+        for (uint64_t k = 0; k < matchCount; k++) {
+            if (index[k].firstEvent > eventCount || index[k].eventCount > eventCount - index[k].firstEvent) return false;
+        }
+        return true;
+    }
+
+    uint64_t getEventCount() const { return eventCount; }
+    uint64_t getMatchCount() const { return matchCount; }
+    uint64_t getBlockCount() const { return (eventCount + blockEvents - 1) / blockEvents; }
+    const MatchIndexEntry& getMatch(uint64_t k) const { return index[k]; }
+
+    // O(1): blocks have a fixed capacity, so the event's offset is computed
+    // directly. n must be below getEventCount(), as every indexed match is.
+    const BallEvent& event(uint64_t n) const {
+        uint64_t block = n / blockEvents;
+        return *(const BallEvent*)(file.data() + blockOffset(block) + sizeof(LogBlockHeader) +
+                                   (size_t)(n % blockEvents) * sizeof(BallEvent));
+    }
+
+    // Events of one block are contiguous in the mapping. A corrupt header
+    // count is clamped to the block's capacity so reads stay in the file.
+    const BallEvent* blockEventsAt(uint64_t block, uint32_t& count) const {
+        const LogBlockHeader* header = (const LogBlockHeader*)(file.data() + blockOffset(block));
+        count = min(header->eventCount, blockCapacity(block));
+        return (const BallEvent*)(header + 1);
+    }
+
+    bool verifyBlock(uint64_t block) const {
+        const LogBlockHeader* header = (const LogBlockHeader*)(file.data() + blockOffset(block));
+        return header->magic == BallLog::BLOCK_MAGIC && header->eventCount == blockCapacity(block) &&
+               header->checksum == Crc32c::compute(header + 1, header->eventCount * sizeof(BallEvent));
+    }
+
+    // Visit every event in log order without copying
+    template <typename Fn>
+    void forEachEvent(Fn&& fn) const {
+        for (uint64_t b = 0; b < getBlockCount(); b++) {
+            uint32_t count;
+            const BallEvent* events = blockEventsAt(b, count);
+            for (uint32_t i = 0; i < count; i++) fn(events[i]);
+        }
+    }
+};
+
+// Aggregate queries answered by scanning a mapped ball log
+class BallLogQueries {
+public:
+    static vector<uint64_t> runsPerOver(const MappedBallLog& log) {
+        vector<uint64_t> runs;
+        log.forEachEvent([&](const BallEvent& e) {
+            size_t over = e.ballIndex / 6;
+            if (over >= runs.size()) runs.resize(over + 1, 0);
+            runs[over] += runsFor((BallOutcome)e.outcome);
+        });
+        return runs;
+    }
+
+    static vector<uint64_t> wicketsPerBowler(const MappedBallLog& log) {
+        vector<uint64_t> wickets;
+        log.forEachEvent([&](const BallEvent& e) {
+            if (e.bowlerId >= wickets.size()) wickets.resize(e.bowlerId + 1, 0);
+            if ((BallOutcome)e.outcome == BallOutcome::WICKET) wickets[e.bowlerId]++;
+        });
+        return wickets;
+    }
+
+    // Innings totals bucketed by score
+    static vector<uint64_t> scoreHistogram(const MappedBallLog& log) {
+        vector<uint64_t> histogram;
+        bool started = false;
+        uint32_t match = 0;
+        uint8_t innings = 0;
+        int score = 0;
+
+        auto close = [&]() {
+            if ((size_t)score >= histogram.size()) histogram.resize(score + 1, 0);
+            histogram[score]++;
+        };
+
+        log.forEachEvent([&](const BallEvent& e) {
+            if (started && (e.matchId != match || e.innings != innings)) {
+                close();
+                score = 0;
+            }
+            started = true;
+            match = e.matchId;
+            innings = e.innings;
+            score += runsFor((BallOutcome)e.outcome);
+        });
+        if (started) close();
+        return histogram;
+    }
+};
+
+/*
+Bit-packed innings record (one 64-bit word per innings):
+  bits  0-35  up to 12 ball outcomes, 3 bits each (BallOutcome, unused slots are 0)
+  bits 36-39  balls bowled
+  bits 40-42  opening striker (index into the batting playing 5)
+  bits 43-45  opening non-striker
+  bits 46-48  opening bowler (index into the bowling playing 5)
+  bits 49-52  batting team index
+  bits 53-56  bowling team index
+Strike rotation and bowler changes are deterministic, so the openers plus the
+outcomes are enough to rebuild who faced and who bowled every ball.
+*/
+class PackedInnings {
+public:
+    static const int MAX_BALLS = 12;
+    static const uint64_t OUTCOME_MASK = (1ull << 36) - 1;
+
+    static uint64_t openers(int striker, int nonStriker, int bowler) {
+        return ((uint64_t)(striker & 7) << 40) | ((uint64_t)(nonStriker & 7) << 43) |
+               ((uint64_t)(bowler & 7) << 46);
+    }
+
+    static uint64_t withTeams(uint64_t word, int battingTeam, int bowlingTeam) {
+        word &= ~(0xFFull << 49);
+        return word | ((uint64_t)(battingTeam & 15) << 49) | ((uint64_t)(bowlingTeam & 15) << 53);
+    }
+
+    static uint64_t appendBall(uint64_t word, BallOutcome outcome) {
+        int balls = ballCount(word);
+        if (balls >= MAX_BALLS) return word;
+        word |= (uint64_t)outcome << (3 * balls);
+        word = (word & ~(0xFull << 36)) | ((uint64_t)(balls + 1) << 36);
+        return word;
+    }
+
+    static int ballCount(uint64_t word) { return (int)((word >> 36) & 15); }
+    static int striker(uint64_t word) { return (int)((word >> 40) & 7); }
+    static int nonStriker(uint64_t word) { return (int)((word >> 43) & 7); }
+    static int bowler(uint64_t word) { return (int)((word >> 46) & 7); }
+    static int battingTeam(uint64_t word) { return (int)((word >> 49) & 15); }
+    static int bowlingTeam(uint64_t word) { return (int)((word >> 53) & 15); }
+
+    static BallOutcome outcomeAt(uint64_t word, int ball) {
+        return (BallOutcome)((word >> (3 * ball)) & 7);
+    }
+
+    // Spread the 12 outcome fields into one byte each (out must hold 16 bytes)
+    static void unpack(uint64_t word, uint8_t* out) {
+#if defined(__BMI2__)
+        uint64_t lo = _pdep_u64(word, 0x0707070707070707ull);
+        uint64_t hi = _pdep_u64((word >> 24) & 0xFFF, 0x0707070707070707ull);
+        memcpy(out, &lo, 8);
+        memcpy(out + 8, &hi, 8);
+#else
+        for (int i = 0; i < 16; i++) out[i] = i < MAX_BALLS ? (uint8_t)((word >> (3 * i)) & 7) : 0;
+#endif
+    }
+};
+
+// Totals produced by a scan over a packed archive
+struct ArchiveSummary {
+    uint64_t innings = 0;
+    uint64_t balls = 0;
+    uint64_t runs = 0;
+    uint64_t wickets = 0;
+    uint64_t fours = 0;
+    uint64_t sixes = 0;
+    int highestScore = 0;
+};
+
+/*
+Packed archive file layout:
+  [PackedArchiveHeader]
+  [uint64_t x inningsCount]   innings 2k and 2k+1 belong to match k
+*/
+struct PackedArchiveHeader {
+    char magic[8];        // "IPLPACK1"
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t inningsCount;
+};
+
+class PackedArchive {
+private:
+    static constexpr size_t CHUNK_WORDS = 1 << 16;
+
+    FILE* file;
+    vector<uint64_t> buffer;
+    uint64_t inningsCount;
+    bool failed;  // sticky, as in BallLog
+
+    void write(const void* data, size_t size, size_t count) {
+        if (count && fwrite(data, size, count, file) != count) failed = true;
+    }
+
+    void flush() {
+        if (buffer.empty()) return;
+        write(buffer.data(), sizeof(uint64_t), buffer.size());
+        buffer.clear();
+    }
+
+public:
+    PackedArchive() : file(nullptr), inningsCount(0), failed(false) {
+        buffer.reserve(CHUNK_WORDS);
+    }
+
+    ~PackedArchive() { close(); }
+
+    PackedArchive(const PackedArchive&) = delete;
+    PackedArchive& operator=(const PackedArchive&) = delete;
+
+    bool open(const string& path) {
+        file = fopen(path.c_str(), "wb");
+        if (!file) return false;
+
+        PackedArchiveHeader header = {};
+        memcpy(header.magic, "IPLPACK1", 8);
+        header.version = 1;
+        failed = false;
+        write(&header, sizeof(header), 1);
+        return !failed;
+    }
+
+    bool isOpen() const { return file != nullptr; }
+
+    void appendMatch(uint64_t firstInnings, uint64_t secondInnings) {
+        buffer.push_back(firstInnings);
+        buffer.push_back(secondInnings);
+        inningsCount += 2;
+        if (buffer.size() >= CHUNK_WORDS) flush();
+    }
+
+    // Flush remaining words and patch the innings count into the header.
+    // False if any write since open() failed.
+    bool close() {
+        if (!file) return !failed;
+        flush();
+
+        PackedArchiveHeader header = {};
+        memcpy(header.magic, "IPLPACK1", 8);
+        header.version = 1;
+        header.inningsCount = inningsCount;
+        if (fseek(file, 0, SEEK_SET) != 0) failed = true;
+        else write(&header, sizeof(header), 1);
+
+        if (ferror(file)) failed = true;
+        if (fclose(file) != 0) failed = true;
+        file = nullptr;
+        return !failed;
+    }
+
+    uint64_t getInningsCount() const { return inningsCount; }
+
+    // Accumulate totals over a block of packed innings
+    static void scan(const uint64_t* words, size_t count, ArchiveSummary& summary) {
+        // Runs and wicket flag per BallOutcome value (index 7 is unused)
+        static const uint8_t runsTable[16] = {0, 1, 2, 3, 4, 6, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+
+        for (size_t i = 0; i < count; i++) {
+            uint64_t word = words[i];
+            int runs = 0, wickets = 0, fours = 0, sixes = 0;
+#if defined(__BMI2__) && defined(__SSSE3__)
+            alignas(16) uint8_t balls[16];
+            PackedInnings::unpack(word, balls);
+            __m128i outcomes = _mm_load_si128((const __m128i*)balls);
+            __m128i runsPerBall = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)runsTable), outcomes);
+            __m128i sums = _mm_sad_epu8(runsPerBall, _mm_setzero_si128());
+            runs = _mm_cvtsi128_si32(sums) + _mm_extract_epi16(sums, 4);
+            wickets = __builtin_popcount(_mm_movemask_epi8(
+                _mm_cmpeq_epi8(outcomes, _mm_set1_epi8((char)BallOutcome::WICKET))));
+            fours = __builtin_popcount(_mm_movemask_epi8(
+                _mm_cmpeq_epi8(outcomes, _mm_set1_epi8((char)BallOutcome::FOUR))));
+            sixes = __builtin_popcount(_mm_movemask_epi8(
+                _mm_cmpeq_epi8(outcomes, _mm_set1_epi8((char)BallOutcome::SIX))));
+#else
+            int balls = PackedInnings::ballCount(word);
+            for (int b = 0; b < balls; b++) {
+                BallOutcome outcome = PackedInnings::outcomeAt(word, b);
+                runs += runsTable[(int)outcome];
+                if (outcome == BallOutcome::WICKET) wickets++;
+                else if (outcome == BallOutcome::FOUR) fours++;
+                else if (outcome == BallOutcome::SIX) sixes++;
+            }
+#endif
+            summary.innings++;
+            summary.balls += PackedInnings::ballCount(word);
+            summary.runs += runs;
+            summary.wickets += wickets;
+            summary.fours += fours;
+            summary.sixes += sixes;
+            summary.highestScore = max(summary.highestScore, runs);
+        }
+    }
+
+    // Stream an archive from disk in large chunks and summarise it
+    static bool scanFile(const string& path, ArchiveSummary& summary) {
+        FILE* in = fopen(path.c_str(), "rb");
+        if (!in) return false;
+
+        PackedArchiveHeader header;
+        if (fread(&header, sizeof(header), 1, in) != 1 || memcmp(header.magic, "IPLPACK1", 8) != 0) {
+            fclose(in);
+            return false;
+        }
+
+        vector<uint64_t> chunk(CHUNK_WORDS);
+        uint64_t remaining = header.inningsCount;
+        while (remaining > 0) {
+            size_t want = (size_t)min<uint64_t>(remaining, CHUNK_WORDS);
+            size_t got = fread(chunk.data(), sizeof(uint64_t), want, in);
+            if (got == 0) break;
+            scan(chunk.data(), got, summary);
+            remaining -= got;
+        }
+
+        fclose(in);
+        return remaining == 0;
+    }
+};
+
+// Byte buffer used to build checkpoints (host byte order, trivially copyable fields)
+class BinaryWriter {
+private:
+    vector<char> bytes;
+
+public:
+    template <typename T>
+    void put(const T& value) {
+        static_assert(is_trivially_copyable<T>::value, "BinaryWriter::put needs a trivially copyable type");
+        const char* p = reinterpret_cast<const char*>(&value);
+        bytes.insert(bytes.end(), p, p + sizeof(T));
+    }
+
+    void putString(string_view text) {
+        put((uint32_t)text.size());
+        bytes.insert(bytes.end(), text.begin(), text.end());
+    }
+
+    const vector<char>& data() const { return bytes; }
+};
+
+// Bounds-checked reader for BinaryWriter output; ok() turns false on truncation
+class BinaryReader {
+private:
+    const char* pos;
+    const char* end;
+    bool good;
+
+public:
+    BinaryReader(const char* data, size_t size) : pos(data), end(data + size), good(true) {}
+
+    template <typename T>
+    T get() {
+        T value{};
+        if ((size_t)(end - pos) < sizeof(T)) {
+            good = false;
+            return value;
+        }
+        memcpy(&value, pos, sizeof(T));
+        pos += sizeof(T);
+        return value;
+    }
+
+    string getString() {
+        uint32_t size = get<uint32_t>();
+        if ((size_t)(end - pos) < size) {
+            good = false;
+            return string();
+        }
+        string text(pos, size);
+        pos += size;
+        return text;
+    }
+
+    bool ok() const { return good; }
+};
+
+// Durable file updates: fsync before rename so a crash leaves the old or new file
+class FileSync {
+public:
+    static bool sync(FILE* f) {
+        if (fflush(f) != 0) return false;
+#if defined(_WIN32)
+        return _commit(_fileno(f)) == 0;
+#else
+        return fsync(fileno(f)) == 0;
+#endif
+    }
+
+    static bool replace(const string& from, const string& to) {
+#if defined(_WIN32)
+        return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+        return rename(from.c_str(), to.c_str()) == 0;
+#endif
+    }
+
+    static bool writeAtomically(const string& path, const void* data, size_t size) {
+        string tmp = path + ".tmp";
+        FILE* out = fopen(tmp.c_str(), "wb");
+        if (!out) return false;
+        bool ok = fwrite(data, 1, size, out) == size && sync(out);
+        fclose(out);
+        return ok && replace(tmp, path);
+    }
+};
+
+/*
+Monotonic arena for objects that live as long as their owner, such as a
+tournament's fixtures. Allocation bumps a pointer through blocks that grow
+geometrically; nothing is freed on its own. Non-trivial destructors are
+chained inside the arena and run newest first by reset(), which then
+returns every block at once.
+*/
+class Arena {
+private:
+    struct Block {
+        Block* next;
+    };
+    
+    struct Cleanup {
+        void (*destroy)(void*);
+        void* object;
+        Cleanup* next;
+    };
+    
+    static constexpr size_t MAX_BLOCK = 1 << 20;
+    
+    Block* blocks;
+    char* cursor;
+    char* limit;
+    Cleanup* cleanups;
+    size_t blockSize;       // size of the next block
+    size_t bytesUsed;
+    
+    static char* align(char* p, size_t alignment) {
+        return reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(p) + alignment - 1) & ~(uintptr_t)(alignment - 1));
+    }
+    
+    void grow(size_t size, size_t alignment) {
+        size_t bytes = max(blockSize, sizeof(Block) + alignment + size);
+        Block* block = static_cast<Block*>(::operator new(bytes));
+        block->next = blocks;
+        blocks = block;
+        cursor = reinterpret_cast<char*>(block + 1);
+        limit = reinterpret_cast<char*>(block) + bytes;
+        blockSize = min(blockSize * 2, MAX_BLOCK);
+    }
+    
+public:
+    explicit Arena(size_t firstBlock = 4096) : blocks(nullptr), cursor(nullptr), limit(nullptr),
+        cleanups(nullptr), blockSize(firstBlock), bytesUsed(0) {}
+    
+    ~Arena() { reset(); }
+    
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+    
+    void* allocate(size_t size, size_t alignment) {
+        char* p = align(cursor, alignment);
+        if (!cursor || size > (size_t)(limit - p)) {
+            grow(size, alignment);
+            p = align(cursor, alignment);
+        }
+        cursor = p + size;
+        bytesUsed += size;
+        return p;
+    }
+    
+    template <typename T, typename... Args>
+    T* make(Args&&... args) {
+        T* object = new (allocate(sizeof(T), alignof(T))) T(forward<Args>(args)...);
+        if (!is_trivially_destructible<T>::value) {
+            void* node = allocate(sizeof(Cleanup), alignof(Cleanup));
+            cleanups = new (node) Cleanup{[](void* o) { static_cast<T*>(o)->~T(); }, object, cleanups};
+        }
+        return object;
+    }
+    
+    // Destroy every object and release all blocks
+    void reset() {
+        for (Cleanup* c = cleanups; c; c = c->next) c->destroy(c->object);
+        cleanups = nullptr;
+        while (blocks) {
+            Block* next = blocks->next;
+            ::operator delete(blocks);
+            blocks = next;
+        }
+        cursor = limit = nullptr;
+        bytesUsed = 0;
+    }
+    
+    size_t getBytesUsed() const { return bytesUsed; }
+};
+
+// Standard allocator over a shared arena, for allocate_shared. Deallocation is
+// a no-op; each control block holds a copy of the allocator, so the arena
+// stays alive until the last object built from it is released.
+template <typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+    
+    shared_ptr<Arena> arena;
+    
+    explicit ArenaAllocator(shared_ptr<Arena> a) : arena(move(a)) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+    
+    T* allocate(size_t n) { return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T))); }
+    void deallocate(T*, size_t) {}
+    
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const { return arena == other.arena; }
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const { return arena != other.arena; }
+};
+
+/*
+Player names interned once into dense 32-bit ids. The strings live in
+fixed-size chunks that never move, and a hash index over views of them maps
+a name back to its id. Tournaments may be built on several threads at once,
+so intern and find take a lock; name(id) does not, since a chunk is
+published before any id inside it is handed out. The chunk table is fixed,
+so interning past 4M names throws length_error.
+*/
+class NameInterner {
+private:
+    static const uint32_t CHUNK = 4096;
+    static const uint32_t MAX_CHUNKS = 1024;   // 4M names
+    
+    mutable mutex lock;
+    atomic<string*> chunks[MAX_CHUNKS];
+    atomic<uint32_t> count;
+    unordered_map<string_view, uint32_t> index;
+    
+public:
+    static const uint32_t NONE = 0xFFFFFFFFu;
+    
+    NameInterner() : count(0) {
+        for (auto& chunk : chunks) chunk.store(nullptr, memory_order_relaxed);
+    }
+    
+    ~NameInterner() {
+        for (auto& chunk : chunks) delete[] chunk.load(memory_order_relaxed);
+    }
+    
+    NameInterner(const NameInterner&) = delete;
+    NameInterner& operator=(const NameInterner&) = delete;
+    
+    static NameInterner& global() {
+        static NameInterner interner;
+        return interner;
+    }
+    
+    uint32_t intern(string_view name) {
+        lock_guard<mutex> guard(lock);
+        auto it = index.find(name);
+        if (it != index.end()) return it->second;
+        uint32_t id = count.load(memory_order_relaxed);
+        if (id / CHUNK >= MAX_CHUNKS) throw length_error("NameInterner: more than 4M player names");
+        string* chunk = chunks[id / CHUNK].load(memory_order_relaxed);
+        if (!chunk) {
+            chunk = new string[CHUNK];
+            chunks[id / CHUNK].store(chunk, memory_order_release);
+        }
+        chunk[id % CHUNK] = string(name);
+        index.emplace(chunk[id % CHUNK], id);
+        count.store(id + 1, memory_order_release);
+        return id;
+    }
+    
+    // NONE if the name was never interned (so it matches no player)
+    uint32_t find(string_view name) const {
+        lock_guard<mutex> guard(lock);
+        auto it = index.find(name);
+        return it == index.end() ? NONE : it->second;
+    }
+    
+    // Empty for NONE or any id not handed out
+    string_view name(uint32_t id) const {
+        if (id >= count.load(memory_order_acquire)) return string_view();
+        return chunks[id / CHUNK].load(memory_order_acquire)[id % CHUNK];
+    }
+    
+    size_t size() const { return count.load(memory_order_acquire); }
+};
+
+// Base Player class
+class Player {
+protected:
+    uint32_t nameId;  // see NameInterner
+    int age;
+    PlayerType type;
+    uint32_t id;  // Stable index used in binary logs
+    int totalCredits;
+    int matchCredits;
+    
+    // Persistent statistics
+    int totalRunsScored;
+    int totalBallsFaced;
+    int totalWicketsTaken;
+    int totalBallsBowled;
+    int totalRunsConceded;
+    
+public:
+    Player(string_view n, int a, PlayerType t) : nameId(NameInterner::global().intern(n)), age(a), type(t), id(0),
+        totalCredits(0), matchCredits(0), totalRunsScored(0), totalBallsFaced(0),
+        totalWicketsTaken(0), totalBallsBowled(0), totalRunsConceded(0) {}
+    
+    virtual ~Player() = default;
+    
+    // Getters
+    string_view getName() const { return NameInterner::global().name(nameId); }
+    uint32_t getNameId() const { return nameId; }
+    int getAge() const { return age; }
+    PlayerType getType() const { return type; }
+    uint32_t getId() const { return id; }
+    void setId(uint32_t playerId) { id = playerId; }
+    int getTotalCredits() const { return totalCredits; }
+    int getMatchCredits() const { return matchCredits; }
+    
+    // Statistics getters
+    int getTotalRunsScored() const { return totalRunsScored; }
+    int getTotalBallsFaced() const { return totalBallsFaced; }
+    int getTotalWicketsTaken() const { return totalWicketsTaken; }
+    int getTotalBallsBowled() const { return totalBallsBowled; }
+    int getTotalRunsConceded() const { return totalRunsConceded; }
+    
+    // Credits by role: 20 runs = 1 credit for batsmen, 1 wicket = 1 credit
+    // for bowlers, and all-rounders earn both
+    void updateCredits(int runs, int wickets) {
+        int credits = (isBatsman() ? runs / 20 : 0) + (isBowler() ? wickets : 0);
+        matchCredits += credits;
+        totalCredits += credits;
+    }
+    void resetMatchCredits() { matchCredits = 0; }
+    
+    // Utility methods
+    bool isBatsman() const { return type == PlayerType::BATSMAN || type == PlayerType::ALLROUNDER; }
+    bool isBowler() const { return type == PlayerType::BOWLER || type == PlayerType::ALLROUNDER; }
+    
+    // Statistics update methods
+    void addToTotalRuns(int runs) { totalRunsScored += runs; }
+    void addToTotalBallsFaced() { totalBallsFaced++; }
+    void addToTotalWickets(int wickets) { totalWicketsTaken += wickets; }
+    void addToTotalBallsBowled() { totalBallsBowled++; }
+    void addToTotalRunsConceded(int runs) { totalRunsConceded += runs; }
+    
+    // Ball updates switch on the type tag instead of a virtual call, so the
+    // whole ball update can inline (defined after the player classes)
+    void addWicket();
+    void addBall();
+    void addRuns(int runs);
+    
+    // Checkpoint support
+    virtual void saveState(BinaryWriter& out) const {
+        out.put(totalCredits);
+        out.put(matchCredits);
+        out.put(totalRunsScored);
+        out.put(totalBallsFaced);
+        out.put(totalWicketsTaken);
+        out.put(totalBallsBowled);
+        out.put(totalRunsConceded);
+    }
+    
+    virtual void loadState(BinaryReader& in) {
+        totalCredits = in.get<int>();
+        matchCredits = in.get<int>();
+        totalRunsScored = in.get<int>();
+        totalBallsFaced = in.get<int>();
+        totalWicketsTaken = in.get<int>();
+        totalBallsBowled = in.get<int>();
+        totalRunsConceded = in.get<int>();
+    }
+};
+
+// Batsman class
+class Batsman final : public Player {
+private:
+    int runsScored;
+    int ballsFaced;
+    int fours;
+    int sixes;
+    
+public:
+    Batsman(const string& name, int age) : Player(name, age, PlayerType::BATSMAN),
+        runsScored(0), ballsFaced(0), fours(0), sixes(0) {}
+    
+    void addRuns(int runs) {
+        runsScored += runs;
+        addToTotalRuns(runs);
+        updateCredits(runs, 0);
+        
+        if (runs == 4) fours++;
+        else if (runs == 6) sixes++;
+    }
+    
+    void addBall() { 
+        ballsFaced++; 
+        addToTotalBallsFaced();
+    }
+    
+    void addBoundary(bool isSix) {
+        if (isSix) sixes++;
+        else fours++;
+    }
+    
+    // Getters
+    int getRunsScored() const { return runsScored; }
+    int getBallsFaced() const { return ballsFaced; }
+    double getStrikeRate() const {
+        return ballsFaced > 0 ? (double)runsScored * 100 / ballsFaced : 0.0;
+    }
+    
+    void resetMatchStats() {
+        runsScored = 0;
+        ballsFaced = 0;
+        fours = 0;
+        sixes = 0;
+        resetMatchCredits();
+    }
+    
+    void saveState(BinaryWriter& out) const override {
+        Player::saveState(out);
+        out.put(runsScored);
+        out.put(ballsFaced);
+        out.put(fours);
+        out.put(sixes);
+    }
+    
+    void loadState(BinaryReader& in) override {
+        Player::loadState(in);
+        runsScored = in.get<int>();
+        ballsFaced = in.get<int>();
+        fours = in.get<int>();
+        sixes = in.get<int>();
+    }
+};
+
+// Bowler class
+class Bowler final : public Player {
+private:
+    int wicketsTaken;
+    int runsConceded;
+    int ballsBowled;
+    int maidens;
+    
+public:
+    Bowler(const string& name, int age) : Player(name, age, PlayerType::BOWLER),
+        wicketsTaken(0), runsConceded(0), ballsBowled(0), maidens(0) {}
+    
+    void addWicket() { 
+        wicketsTaken++; 
+        addToTotalWickets(1);
+        updateCredits(0, 1);
+    }
+    
+    void addRuns(int runs) { 
+        runsConceded += runs; 
+        addToTotalRunsConceded(runs);
+    }
+    
+    void addBall() { 
+        ballsBowled++; 
+        addToTotalBallsBowled();
+    }
+    
+    void addMaiden() { maidens++; }
+    
+    // Getters
+    int getWicketsTaken() const { return wicketsTaken; }
+    int getRunsConceded() const { return runsConceded; }
+    double getEconomyRate() const {
+        return ballsBowled > 0 ? (double)runsConceded * 6 / ballsBowled : 0.0;
+    }
+    double getAverage() const {
+        return wicketsTaken > 0 ? (double)runsConceded / wicketsTaken : 0.0;
+    }
+    
+    void resetMatchStats() {
+        wicketsTaken = 0;
+        runsConceded = 0;
+        ballsBowled = 0;
+        maidens = 0;
+        resetMatchCredits();
+    }
+    
+    void saveState(BinaryWriter& out) const override {
+        Player::saveState(out);
+        out.put(wicketsTaken);
+        out.put(runsConceded);
+        out.put(ballsBowled);
+        out.put(maidens);
+    }
+    
+    void loadState(BinaryReader& in) override {
+        Player::loadState(in);
+        wicketsTaken = in.get<int>();
+        runsConceded = in.get<int>();
+        ballsBowled = in.get<int>();
+        maidens = in.get<int>();
+    }
+};
+
+// Match figures kept by an all-rounder (the same counters Batsman and Bowler hold)
+struct BattingFigures {
+    int runsScored;
+    int ballsFaced;
+    int fours;
+    int sixes;
+};
+
+struct BowlingFigures {
+    int wicketsTaken;
+    int runsConceded;
+    int ballsBowled;
+    int maidens;
+};
+
+// AllRounder class: one Player (name, totals, credits) with both sets of figures
+class AllRounder final : public Player {
+private:
+    BattingFigures batting;
+    BowlingFigures bowling;
+    
+public:
+    AllRounder(const string& name, int age) : Player(name, age, PlayerType::ALLROUNDER),
+        batting(), bowling() {}
+    
+    void addBattingRuns(int runs) {
+        batting.runsScored += runs;
+        addToTotalRuns(runs);
+        updateCredits(runs, 0);
+        if (runs == 4) batting.fours++;
+        else if (runs == 6) batting.sixes++;
+    }
+    
+    void addBowlingWicket() {
+        bowling.wicketsTaken++;
+        addToTotalWickets(1);
+        updateCredits(0, 1);
+    }
+    
+    void addBowlingRuns(int runs) {
+        bowling.runsConceded += runs;
+        addToTotalRunsConceded(runs);
+    }
+    
+    void resetMatchStats() {
+        batting = BattingFigures();
+        bowling = BowlingFigures();
+        resetMatchCredits();
+    }
+    
+    void saveState(BinaryWriter& out) const override {
+        Player::saveState(out);
+        out.put(batting);
+        out.put(bowling);
+    }
+    
+    void loadState(BinaryReader& in) override {
+        Player::loadState(in);
+        batting = in.get<BattingFigures>();
+        bowling = in.get<BowlingFigures>();
+    }
+};
+
+// Closed-set dispatch for the per-ball updates. All-rounders keep only the
+// base totals here; their figures are updated through the add* methods above.
+inline void Player::addWicket() {
+    if (type == PlayerType::BOWLER) static_cast<Bowler*>(this)->addWicket();
+    else addToTotalWickets(1);
+}
+
+inline void Player::addBall() {
+    switch (type) {
+        case PlayerType::BATSMAN: static_cast<Batsman*>(this)->addBall(); break;
+        case PlayerType::BOWLER: static_cast<Bowler*>(this)->addBall(); break;
+        default: addToTotalBallsBowled(); break;
+    }
+}
+
+inline void Player::addRuns(int runs) {
+    switch (type) {
+        case PlayerType::BATSMAN: static_cast<Batsman*>(this)->addRuns(runs); break;
+        case PlayerType::BOWLER: static_cast<Bowler*>(this)->addRuns(runs); break;
+        default: addToTotalRuns(runs); break;
+    }
+}
+
+// Players of one tournament packed into a shared arena: each player and its
+// shared_ptr control block are bump-allocated next to the previous one
+class PlayerPool {
+private:
+    shared_ptr<Arena> arena;
+    
+public:
+    PlayerPool() : arena(make_shared<Arena>(16 * 1024)) {}
+    
+    shared_ptr<Player> make(PlayerType type, const string& name, int age) {
+        switch (type) {
+            case PlayerType::BOWLER: return allocate_shared<Bowler>(ArenaAllocator<Bowler>(arena), name, age);
+            case PlayerType::ALLROUNDER: return allocate_shared<AllRounder>(ArenaAllocator<AllRounder>(arena), name, age);
+            default: return allocate_shared<Batsman>(ArenaAllocator<Batsman>(arena), name, age);
+        }
+    }
+};
+
+// Read-only view of a lineup as player ids, in batting order (a C++17
+// stand-in for span<const uint32_t>); valid while the team's selection is
+struct Lineup {
+    const uint32_t* ids;
+    size_t count;
+    
+    const uint32_t* begin() const { return ids; }
+    const uint32_t* end() const { return ids + count; }
+    size_t size() const { return count; }
+    uint32_t operator[](size_t i) const { return ids[i]; }
+};
+
+// Team class
+class Team {
+private:
+    string name;
+    string city;
+    vector<shared_ptr<Player>> roster;  // 5 players
+    vector<shared_ptr<Player>> playing5;  // 5 players
+    vector<uint32_t> playing5Ids;         // the same players by id
+    int points;
+    int matchesPlayed;
+    int matchesWon;
+    int matchesLost;
+    int matchesTied;
+    
+public:
+    Team(const string& n, const string& c) : name(n), city(c), points(0), 
+        matchesPlayed(0), matchesWon(0), matchesLost(0), matchesTied(0) {}
+    
+    // Team management
+    void addPlayer(shared_ptr<Player> player) {
+        roster.push_back(player);
+    }
+    
+    // Player ids must be assigned before selection
+    void selectPlaying5() {
+        playing5 = roster;  // All 5 players play
+        playing5Ids.clear();
+        for (const auto& player : playing5) playing5Ids.push_back(player->getId());
+    }
+    
+    bool validatePlaying5() const {
+        int bowlers = 0, batsmen = 0;
+        for (const auto& player : playing5) {
+            if (player->isBowler()) bowlers++;
+            if (player->isBatsman()) batsmen++;
+        }
+        return bowlers >= 2 && batsmen >= 2;
+    }
+    
+    // Match results
+    void addPoints(int pts) { points += pts; }
+    
+    void updateMatchResult(MatchResult result) {
+        matchesPlayed++;
+        switch (result) {
+            case MatchResult::WIN: matchesWon++; break;
+            case MatchResult::LOSS: matchesLost++; break;
+            case MatchResult::TIE: matchesTied++; break;
+            default: break;
+        }
+    }
+    
+    // Getters
+    const string& getName() const { return name; }
+    const string& getCity() const { return city; }
+    const vector<shared_ptr<Player>>& getPlaying5() const { return playing5; }
+    Lineup getLineup() const { return {playing5Ids.data(), playing5Ids.size()}; }
+    int getPoints() const { return points; }
+    int getMatchesPlayed() const { return matchesPlayed; }
+    int getMatchesWon() const { return matchesWon; }
+    int getMatchesLost() const { return matchesLost; }
+    int getMatchesTied() const { return matchesTied; }
+    double getWinPercentage() const {
+        return matchesPlayed > 0 ? (double)matchesWon * 100 / matchesPlayed : 0.0;
+    }
+    
+    const vector<shared_ptr<Player>>& getRoster() const { return roster; }
+    
+    // Checkpoint support (the roster is saved by the tournament)
+    void saveState(BinaryWriter& out) const {
+        out.put(points);
+        out.put(matchesPlayed);
+        out.put(matchesWon);
+        out.put(matchesLost);
+        out.put(matchesTied);
+    }
+    
+    void loadState(BinaryReader& in) {
+        points = in.get<int>();
+        matchesPlayed = in.get<int>();
+        matchesWon = in.get<int>();
+        matchesLost = in.get<int>();
+        matchesTied = in.get<int>();
+    }
+    
+    // Player search
+    shared_ptr<Player> findPlayer(string_view playerName) const {
+        uint32_t nameId = NameInterner::global().find(playerName);
+        for (const auto& player : playing5) {
+            if (player->getNameId() == nameId) return player;
+        }
+        return nullptr;
+    }
+};
+
+// Scoring state of one innings: who is on strike, who bowls, and the score.
+// Plain data with no player references, so a snapshot is a memcpy and what-if
+// forks can continue it without touching teams or players.
+struct InningsState {
+    int8_t striker;
+    int8_t nonStriker;
+    int8_t bowler;
+    int8_t previousBowler;
+    uint8_t batters;       // size of the batting order
+    uint8_t bowlers;       // size of the bowling order
+    uint8_t wickets;
+    uint8_t overs;
+    uint16_t runs;
+    uint8_t balls;
+    uint8_t overBalls;
+    
+    static InningsState opening(int battingCount, int bowlingCount) {
+        InningsState s;
+        s.striker = 0;
+        s.nonStriker = 1;
+        s.bowler = 0;
+        s.previousBowler = -1;
+        s.batters = (uint8_t)battingCount;
+        s.bowlers = (uint8_t)bowlingCount;
+        s.wickets = 0;
+        s.overs = 0;
+        s.runs = 0;
+        s.balls = 0;
+        s.overBalls = 0;
+        return s;
+    }
+    
+    bool isComplete() const {
+        return wickets >= 2 || overs >= 2;
+    }
+    
+    // Score a delivery (5 = wicket); strike and batsman changes happen here
+    void score(int outcome) {
+        if (outcome == 5) {
+            wickets++;
+            changeBatsman();
+        } else {
+            runs += outcome;
+            if (outcome % 2 == 1) changeStrike();
+        }
+    }
+    
+    // Count the delivery and change bowler every 6 balls
+    void countBall() {
+        SimStats::add(Counter::BALLS);
+        balls++;
+        overBalls++;
+        if (overBalls == 6) {
+            changeBowler();
+            overBalls = 0;
+            overs++;
+        }
+    }
+    
+    void advance(int outcome) {
+        score(outcome);
+        countBall();
+    }
+    
+    // State reached by the default rotation after the given score
+    static InningsState at(int runs, int wickets, int overs, int overBalls,
+                           int battingCount = 5, int bowlingCount = 5) {
+        InningsState s = opening(battingCount, bowlingCount);
+        s.runs = (uint16_t)runs;
+        s.wickets = (uint8_t)wickets;
+        s.overs = (uint8_t)overs;
+        s.overBalls = (uint8_t)overBalls;
+        s.balls = (uint8_t)(overs * 6 + overBalls);
+        s.nonStriker = (int8_t)min(wickets + 1, battingCount - 1);
+        if (overs > 0) {
+            s.bowler = (int8_t)(overs % bowlingCount);
+            s.previousBowler = (int8_t)((overs - 1) % bowlingCount);
+        }
+        return s;
+    }
+    
+    void changeStrike() {
+        swap(striker, nonStriker);
+    }
+    
+    void changeBatsman() {
+        int nextBatsman = max(striker, nonStriker) + 1;
+        if (nextBatsman < batters) {
+            if (striker > nonStriker) {
+                striker = (int8_t)nextBatsman;
+            } else {
+                nonStriker = (int8_t)nextBatsman;
+            }
+        }
+    }
+    
+    void changeBowler() {
+        if (bowlers < 2) return;
+        previousBowler = bowler;
+        do {
+            bowler = (int8_t)((bowler + 1) % bowlers);
+        } while (bowler == previousBowler);
+    }
+};
+
+static_assert(is_trivially_copyable<InningsState>::value, "InningsState is forked by copy");
+static_assert(sizeof(InningsState) == 12, "InningsState layout changed");
+
+// Typed simulation event. Published on the EventBus by Innings (per ball) and
+// Match (start, innings end, result); 32 bytes, no heap data.
+struct GameEvent {
+    enum Kind : uint8_t { MATCH_START, BALL, WICKET, OVER_COMPLETE, INNINGS_END, MATCH_END };
+    
+    uint8_t kind;
+    uint8_t innings;       // 0 or 1
+    uint8_t outcome;       // BallOutcome (BALL, WICKET)
+    uint8_t detail;        // MATCH_START: 1 for a replay; MATCH_END: MatchResult
+    uint32_t matchId;
+    uint32_t strikerId;    // faced the delivery
+    uint32_t bowlerId;
+    uint32_t onStrikeId;   // on strike after the delivery
+    InningsState state;    // after the delivery / at innings end
+    
+    BallEvent toBallEvent() const {
+        BallEvent event;
+        event.matchId = matchId;
+        event.strikerId = strikerId;
+        event.bowlerId = bowlerId;
+        event.innings = innings;
+        event.ballIndex = (uint8_t)(state.balls - 1);
+        event.outcome = outcome;
+        event.reserved = 0;
+        return event;
+    }
+};
+
+static_assert(sizeof(GameEvent) == 32, "GameEvent layout changed");
+
+class EventSubscriber {
+public:
+    virtual ~EventSubscriber() = default;
+    virtual void onEvent(const GameEvent& event) = 0;
+};
+
+/*
+Synchronous fan-out from the simulation thread. Subscribers are a fixed
+array, so publishing is a loop of virtual calls with no allocation; consumers
+on other threads subscribe through a ring (see ScoreStream).
+*/
+class EventBus {
+private:
+    static const int MAX_SUBSCRIBERS = 8;
+    
+    EventSubscriber* subscribers[MAX_SUBSCRIBERS];
+    int count;
+    
+public:
+    EventBus() : count(0) {}
+    
+    bool subscribe(EventSubscriber* subscriber) {
+        for (int i = 0; i < count; i++) {
+            if (subscribers[i] == subscriber) return true;
+        }
+        if (count == MAX_SUBSCRIBERS) return false;
+        subscribers[count++] = subscriber;
+        return true;
+    }
+    
+    void unsubscribe(EventSubscriber* subscriber) {
+        int kept = 0;
+        for (int i = 0; i < count; i++) {
+            if (subscribers[i] != subscriber) subscribers[kept++] = subscribers[i];
+        }
+        count = kept;
+    }
+    
+    void publish(const GameEvent& event) const {
+        for (int i = 0; i < count; i++) subscribers[i]->onEvent(event);
+    }
+    
+    bool empty() const { return count == 0; }
+};
+
+// Writes ball events to a BallLog
+class BallLogSubscriber : public EventSubscriber {
+private:
+    BallLog* log;
+    
+public:
+    explicit BallLogSubscriber(BallLog* l = nullptr) : log(l) {}
+    
+    void onEvent(const GameEvent& event) override {
+        if (event.kind == GameEvent::MATCH_START) log->beginMatch(event.matchId);
+        else if (event.kind == GameEvent::BALL) log->append(event.toBallEvent());
+    }
+};
+
+// Single-producer single-consumer ring. Push fails instead of waiting when
+// the consumer is behind, so the producer never blocks.
+template <typename T>
+class SpscRing {
+private:
+    vector<T> slots;
+    uint64_t mask;
+    alignas(64) atomic<uint64_t> head;  // next slot to write (producer)
+    alignas(64) atomic<uint64_t> tail;  // next slot to read (consumer)
+    
+public:
+    explicit SpscRing(size_t capacity) : head(0), tail(0) {
+        size_t size = 1;
+        while (size < capacity) size <<= 1;
+        slots.resize(size);
+        mask = size - 1;
+    }
+    
+    bool tryPush(const T& value) {
+        uint64_t h = head.load(memory_order_relaxed);
+        if (h - tail.load(memory_order_acquire) == slots.size()) return false;
+        slots[h & mask] = value;
+        head.store(h + 1, memory_order_release);
+        return true;
+    }
+    
+    bool tryPop(T& value) {
+        uint64_t t = tail.load(memory_order_relaxed);
+        if (t == head.load(memory_order_acquire)) return false;
+        value = slots[t & mask];
+        tail.store(t + 1, memory_order_release);
+        return true;
+    }
+    
+    bool empty() const { return tail.load(memory_order_acquire) == head.load(memory_order_acquire); }
+};
+
+// One message for score subscribers
+struct StreamEvent {
+    enum Kind : uint8_t { BALL = 1, STANDINGS = 2, END = 3 };
+    static const int MAX_TEAMS = 16;
+    
+    uint8_t kind;
+    uint8_t teamCount;
+    uint16_t reserved;
+    uint32_t matchId;
+    BallEvent ball;                 // BALL
+    int16_t points[MAX_TEAMS];      // STANDINGS, by team index
+};
+
+// Events from the simulation thread to the score server. Subscribes to the
+// bus for ball events; publishing never waits: if the ring is full the
+// event is dropped and counted.
+class ScoreStream : public EventSubscriber {
+private:
+    SpscRing<StreamEvent> ring;
+    atomic<uint64_t> dropped;
+    atomic<bool> finished;
+    
+    void push(const StreamEvent& event) {
+        if (!ring.tryPush(event)) dropped.fetch_add(1, memory_order_relaxed);
+    }
+    
+public:
+    explicit ScoreStream(size_t capacity = 1 << 16) : ring(capacity), dropped(0), finished(false) {}
+    
+    void publishBall(const BallEvent& ball) {
+        StreamEvent event;
+        event.kind = StreamEvent::BALL;
+        event.teamCount = 0;
+        event.reserved = 0;
+        event.matchId = ball.matchId;
+        event.ball = ball;
+        push(event);
+    }
+    
+    void publishStandings(uint32_t matchId, const int* points, size_t count) {
+        StreamEvent event;
+        event.kind = StreamEvent::STANDINGS;
+        event.teamCount = (uint8_t)min<size_t>(count, StreamEvent::MAX_TEAMS);
+        event.reserved = 0;
+        event.matchId = matchId;
+        for (int t = 0; t < event.teamCount; t++) event.points[t] = (int16_t)points[t];
+        push(event);
+    }
+    
+    void onEvent(const GameEvent& event) override {
+        if (event.kind == GameEvent::BALL) publishBall(event.toBallEvent());
+    }
+    
+    // No more events; the server sends END once the ring is drained
+    void finish() { finished.store(true, memory_order_release); }
+    
+    bool poll(StreamEvent& event) { return ring.tryPop(event); }
+    bool isFinished() const { return finished.load(memory_order_acquire) && ring.empty(); }
+    uint64_t getDropped() const { return dropped.load(memory_order_relaxed); }
+};
+
+// Innings class to manage one team's batting
+class Innings {
+private:
+    Team* battingTeam;
+    Team* bowlingTeam;
+    const vector<shared_ptr<Player>>& battingOrder;     // the teams' playing fives
+    const vector<shared_ptr<Player>>& bowlingOrder;
+    Lineup battingIds;      // the same players by id, for events and replay
+    Lineup bowlingIds;
+    
+    InningsState state;
+    
+    // Ball, wicket and over events go to the bus (commentary, logs, servers)
+    EventBus* bus;
+    uint32_t matchId;
+    uint8_t inningsNumber;
+    
+    // Bit-packed record of this innings (see PackedInnings)
+    uint64_t packedRecord;
+    
+    // Outcome generator, normally owned by the tournament so runs can be checkpointed
+    mt19937* rng;
+    
+    // Seeded from the clock and thread, so no random_device is opened
+    static mt19937& fallbackRandom() {
+        thread_local mt19937 gen((uint32_t)(chrono::steady_clock::now().time_since_epoch().count() ^
+                                            hash<thread::id>()(this_thread::get_id())));
+        return gen;
+    }
+    
+    // Random ball outcomes
+    static constexpr int ballOutcomes[] = {0, 1, 2, 3, 4, 5, 6};  // 5 = wicket
+    static constexpr int OUTCOME_COUNT = sizeof(ballOutcomes) / sizeof(ballOutcomes[0]);
+    
+public:
+    // Nothing is copied: the innings reads the teams' playing fives and
+    // lineups, which are fixed before fixtures are generated
+    Innings(Team* batting, Team* bowling) : battingTeam(batting), bowlingTeam(bowling),
+        battingOrder(batting->getPlaying5()), bowlingOrder(bowling->getPlaying5()),
+        battingIds(batting->getLineup()), bowlingIds(bowling->getLineup()), bus(nullptr), matchId(0), inningsNumber(0), packedRecord(0), rng(nullptr) {
+        
+        state = InningsState::opening((int)battingOrder.size(), (int)bowlingOrder.size());
+    }
+    
+    // Setup methods
+    void attachBus(EventBus* b, uint32_t match, uint8_t innings) {
+        bus = b;
+        matchId = match;
+        inningsNumber = innings;
+    }
+    
+    void setRandom(mt19937* gen) { rng = gen; }
+    
+    // Names resolve to interned ids once; the scans compare integers
+    void setBatsmen(string_view striker, string_view nonStriker) {
+        uint32_t strikerId = NameInterner::global().find(striker);
+        uint32_t nonStrikerId = NameInterner::global().find(nonStriker);
+        for (int i = 0; i < battingOrder.size(); i++) {
+            if (battingOrder[i]->getNameId() == strikerId) state.striker = (int8_t)i;
+            if (battingOrder[i]->getNameId() == nonStrikerId) state.nonStriker = (int8_t)i;
+        }
+    }
+    
+    void setBowler(string_view bowlerName) {
+        uint32_t bowlerId = NameInterner::global().find(bowlerName);
+        for (int i = 0; i < bowlingOrder.size(); i++) {
+            if (bowlingOrder[i]->getNameId() == bowlerId) state.bowler = (int8_t)i;
+        }
+    }
+    
+    // Game logic
+    void playBall() {
+        if (isInningsComplete()) return;
+        
+        // Random ball outcome
+        mt19937& gen = rng ? *rng : fallbackRandom();
+        uniform_int_distribution<> dis(0, OUTCOME_COUNT - 1);
+        SimStats::add(Counter::RNG_DRAWS);
+        int outcome = ballOutcomes[dis(gen)];
+        
+        applyBall(outcome);
+    }
+    
+    // Re-apply a logged delivery: the recorded striker and bowler take the ball
+    void replayBall(const BallEvent& event) {
+        if (isInningsComplete()) return;
+        
+        if (battingIds[state.nonStriker] == event.strikerId) {
+            state.changeStrike();
+        } else if (battingIds[state.striker] != event.strikerId) {
+            for (int i = 0; i < (int)battingIds.size(); i++) {
+                if (battingIds[i] == event.strikerId) state.striker = (int8_t)i;
+            }
+        }
+        for (int i = 0; i < (int)bowlingIds.size(); i++) {
+            if (bowlingIds[i] == event.bowlerId) state.bowler = (int8_t)i;
+        }
+        
+        applyBall(toRawOutcome((BallOutcome)event.outcome));
+    }
+    
+    void applyBall(int outcome) {
+        if (state.balls == 0) packedRecord = PackedInnings::openers(state.striker, state.nonStriker, state.bowler);
+        packedRecord = PackedInnings::appendBall(packedRecord, toBallOutcome(outcome));
+        
+        Player* striker = battingOrder[state.striker].get();
+        Player* bowler = bowlingOrder[state.bowler].get();
+        uint32_t strikerId = battingIds[state.striker];
+        uint32_t bowlerId = bowlingIds[state.bowler];
+        
+        // Update statistics based on outcome
+        if (outcome == 5) {  // Wicket
+            bowler->addWicket();
+            bowler->addBall();
+        } else {  // Runs
+            striker->addRuns(outcome);
+            striker->addBall();
+        }
+        bowler->addBall();
+        
+        // Strike rotation and batsman change, then the ball and over count
+        state.score(outcome);
+        state.countBall();
+        
+        if (bus && !bus->empty()) {
+            GameEvent event;
+            event.kind = GameEvent::BALL;
+            event.innings = inningsNumber;
+            event.outcome = (uint8_t)toBallOutcome(outcome);
+            event.detail = 0;
+            event.matchId = matchId;
+            event.strikerId = strikerId;
+            event.bowlerId = bowlerId;
+            event.onStrikeId = battingIds[state.striker];
+            event.state = state;
+            bus->publish(event);
+            
+            if (outcome == 5) {
+                event.kind = GameEvent::WICKET;
+                bus->publish(event);
+            }
+            if (state.overBalls == 0) {
+                event.kind = GameEvent::OVER_COMPLETE;
+                bus->publish(event);
+            }
+        }
+    }
+    
+    void changeStrike() { state.changeStrike(); }
+    void changeBatsman() { state.changeBatsman(); }
+    void changeBowler() { state.changeBowler(); }
+    
+    bool isInningsComplete() const {
+        return state.isComplete();
+    }
+    
+    // Snapshot of the scoring state at the current ball
+    const InningsState& getState() const { return state; }
+    
+    // Getters
+    int getTotalRuns() const { return state.runs; }
+    int getTotalWickets() const { return state.wickets; }
+    uint64_t getPackedRecord() const { return packedRecord; }
+    
+    // Checkpoint support
+    void saveState(BinaryWriter& out) const {
+        out.put(state);
+        out.put(packedRecord);
+    }
+    
+    void loadState(BinaryReader& in) {
+        state = in.get<InningsState>();
+        packedRecord = in.get<uint64_t>();
+    }
+    
+    shared_ptr<Player> getPlayerOfInnings() const {
+        shared_ptr<Player> bestPlayer = nullptr;
+        int maxCredits = -1;
+        
+        for (const auto& player : battingOrder) {
+            if (player->getMatchCredits() > maxCredits) {
+                maxCredits = player->getMatchCredits();
+                bestPlayer = player;
+            }
+        }
+        
+        for (const auto& player : bowlingOrder) {
+            if (player->getMatchCredits() > maxCredits) {
+                maxCredits = player->getMatchCredits();
+                bestPlayer = player;
+            }
+        }
+        
+        return bestPlayer;
+    }
+};
+
+// Both innings of a match; the second is live once the first is complete
+struct MatchState {
+    InningsState innings[2];
+    
+    bool isComplete() const { return innings[0].isComplete() && innings[1].isComplete(); }
+};
+
+static_assert(is_trivially_copyable<MatchState>::value, "MatchState is forked by copy");
+
+// Outcome distribution over forked continuations of one MatchState
+struct WhatIfResult {
+    uint64_t forks = 0;
+    uint64_t firstWins = 0;
+    uint64_t secondWins = 0;
+    uint64_t ties = 0;
+    vector<uint64_t> firstTotals;   // final runs -> count
+    vector<uint64_t> secondTotals;
+    
+    void merge(const WhatIfResult& other) {
+        forks += other.forks;
+        firstWins += other.firstWins;
+        secondWins += other.secondWins;
+        ties += other.ties;
+        for (size_t r = 0; r < other.firstTotals.size(); r++) firstTotals[r] += other.firstTotals[r];
+        for (size_t r = 0; r < other.secondTotals.size(); r++) secondTotals[r] += other.secondTotals[r];
+    }
+    
+    double mean(const vector<uint64_t>& totals) const {
+        double sum = 0;
+        for (size_t r = 0; r < totals.size(); r++) sum += (double)r * totals[r];
+        return forks ? sum / forks : 0;
+    }
+    
+    int percentile(const vector<uint64_t>& totals, double q) const {
+        uint64_t rank = (uint64_t)(q * forks);
+        uint64_t seen = 0;
+        for (size_t r = 0; r < totals.size(); r++) {
+            seen += totals[r];
+            if (seen > rank) return (int)r;
+        }
+        return totals.empty() ? 0 : (int)totals.size() - 1;
+    }
+};
+
+// splitmix64 generator for forks; outcomes are uniform over 0-6 like Innings::playBall
+struct ForkRandom {
+    uint64_t state;
+    
+    uint64_t next() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+    
+    int outcome() {
+        SimStats::add(Counter::RNG_DRAWS);
+        return (int)(((next() >> 32) * 7) >> 32);
+    }
+};
+
+// Monte Carlo continuations of a match snapshot. Each fork is a copy of the
+// 24-byte MatchState plus an 8-byte generator, so no players are touched.
+class WhatIf {
+private:
+    static const int MAX_BALLS = 12;  // 2 overs per innings
+    
+    static void simulate(const MatchState& from, uint64_t forks, uint64_t seed, WhatIfResult& out) {
+        TraceSpan span("whatIfForks", "forks", (int64_t)forks);
+        ForkRandom random{seed};
+        for (uint64_t f = 0; f < forks; f++) {
+            MatchState m = from;
+            playOut(m, random);
+            
+            out.firstTotals[m.innings[0].runs]++;
+            out.secondTotals[m.innings[1].runs]++;
+            if (m.innings[0].runs > m.innings[1].runs) out.firstWins++;
+            else if (m.innings[1].runs > m.innings[0].runs) out.secondWins++;
+            else out.ties++;
+        }
+        out.forks += forks;
+    }
+    
+public:
+    // Play the remaining deliveries of both innings
+    static void playOut(MatchState& m, ForkRandom& random) {
+        SimStats::add(Counter::FORKS);
+        for (auto& innings : m.innings) {
+            while (!innings.isComplete()) innings.advance(random.outcome());
+        }
+    }
+    
+    static WhatIfResult run(const MatchState& from, uint64_t forks, unsigned threads, uint64_t seed) {
+        PhaseTimer timer(Counter::MONTE_CARLO_NS);
+        threads = (unsigned)max<uint64_t>(1, min<uint64_t>(threads, forks));
+        
+        vector<WhatIfResult> partials(threads);
+        for (auto& partial : partials) {
+            partial.firstTotals.resize(from.innings[0].runs + 6 * MAX_BALLS + 1);
+            partial.secondTotals.resize(from.innings[1].runs + 6 * MAX_BALLS + 1);
+        }
+        
+        uint64_t perThread = forks / threads;
+        vector<thread> workers;
+        for (unsigned t = 0; t < threads; t++) {
+            uint64_t count = perThread + (t < forks % threads ? 1 : 0);
+            uint64_t threadSeed = seed + t * 0xD1B54A32D192ED03ull;
+            if (threads == 1) simulate(from, count, threadSeed, partials[t]);
+            else workers.emplace_back([&, t, count, threadSeed] { simulate(from, count, threadSeed, partials[t]); });
+        }
+        for (auto& w : workers) w.join();
+        
+        for (unsigned t = 1; t < threads; t++) partials[0].merge(partials[t]);
+        return partials[0];
+    }
+};
+
+#if defined(__cpp_impl_coroutine)
+// Coroutine handle for a match that suspends after every ball (C++20 builds).
+// Created suspended; resume() plays one ball and returns false once finished.
+class MatchTask {
+public:
+    struct promise_type {
+        MatchTask get_return_object() { return MatchTask(coroutine_handle<promise_type>::from_promise(*this)); }
+        suspend_always initial_suspend() noexcept { return {}; }
+        suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { terminate(); }
+    };
+    
+private:
+    coroutine_handle<promise_type> handle;
+    
+    explicit MatchTask(coroutine_handle<promise_type> h) : handle(h) {}
+    
+public:
+    MatchTask(MatchTask&& other) noexcept : handle(exchange(other.handle, nullptr)) {}
+    MatchTask& operator=(MatchTask&& other) noexcept {
+        if (this != &other) {
+            if (handle) handle.destroy();
+            handle = exchange(other.handle, nullptr);
+        }
+        return *this;
+    }
+    ~MatchTask() { if (handle) handle.destroy(); }
+    
+    bool resume() {
+        if (!handle || handle.done()) return false;
+        handle.resume();
+        return !handle.done();
+    }
+    
+    bool done() const { return !handle || handle.done(); }
+};
+#endif
+
+// Match class
+class Match {
+private:
+    Team* team1;
+    Team* team2;
+    Innings innings1;
+    Innings innings2;
+    
+    MatchResult result;
+    shared_ptr<Player> playerOfMatch;
+    string venue;
+    string date;
+    
+    uint32_t matchId;
+    EventBus* bus;
+    
+    PackedArchive* archive;
+    int team1Index;
+    int team2Index;
+    
+public:
+    Match(Team* t1, Team* t2, const string& v, const string& d) : 
+        team1(t1), team2(t2), innings1(t1, t2), innings2(t2, t1), venue(v), date(d), matchId(0),
+        bus(nullptr), archive(nullptr), team1Index(0), team2Index(0) {}
+    
+    void setMatchId(uint32_t id) { matchId = id; }
+    
+    // Set the match id first; events carry it
+    void attachBus(EventBus* b) {
+        bus = b;
+        innings1.attachBus(b, matchId, 0);
+        innings2.attachBus(b, matchId, 1);
+    }
+    
+    void attachArchive(PackedArchive* a, int firstTeamIndex, int secondTeamIndex) {
+        archive = a;
+        team1Index = firstTeamIndex;
+        team2Index = secondTeamIndex;
+    }
+    
+    void setRandom(mt19937* gen) {
+        innings1.setRandom(gen);
+        innings2.setRandom(gen);
+    }
+    
+    // Checkpoint support; players are resolved by id
+    void saveState(BinaryWriter& out) const {
+        bool played = playerOfMatch != nullptr;
+        out.put(played);
+        if (!played) return;
+        out.put(result);
+        out.put(playerOfMatch->getId());
+        innings1.saveState(out);
+        innings2.saveState(out);
+    }
+    
+    void loadState(BinaryReader& in, const vector<shared_ptr<Player>>& players) {
+        if (!in.get<bool>()) return;
+        result = in.get<MatchResult>();
+        uint32_t best = in.get<uint32_t>();
+        playerOfMatch = best < players.size() ? players[best] : nullptr;
+        innings1.loadState(in);
+        innings2.loadState(in);
+    }
+    
+    // Setup methods
+    void setupInnings() {
+        string striker, nonStriker, bowler;
+        
+        cout << "\n=== Setting up " << team1->getName() << " innings ===" << endl;
+        cout << "Enter striker name: ";
+        cin >> striker;
+        cout << "Enter non-striker name: ";
+        cin >> nonStriker;
+        cout << "Enter bowler name: ";
+        cin >> bowler;
+        
+        innings1.setBatsmen(striker, nonStriker);
+        innings1.setBowler(bowler);
+        
+        cout << "\n=== Setting up " << team2->getName() << " innings ===" << endl;
+        cout << "Enter striker name: ";
+        cin >> striker;
+        cout << "Enter non-striker name: ";
+        cin >> nonStriker;
+        cout << "Enter bowler name: ";
+        cin >> bowler;
+        
+        innings2.setBatsmen(striker, nonStriker);
+        innings2.setBowler(bowler);
+    }
+    
+    // Match execution
+    void playMatch() {
+        TraceSpan span("playMatch", "match", matchId);
+        startMatch();
+        playInnings(innings1, 1);
+        publish(GameEvent::INNINGS_END, 0, innings1.getState(), 0);
+        playInnings(innings2, 2);
+        finishMatch();
+    }
+    
+    void playInnings(Innings& innings, int number) {
+        TraceSpan span("innings", "innings", number);
+        while (!innings.isInningsComplete()) {
+            innings.playBall();
+        }
+    }
+    
+#if defined(__cpp_impl_coroutine)
+    // The same match as a coroutine suspending after each ball, for
+    // schedulers that interleave many matches (see MatchDay)
+    MatchTask play() {
+        startMatch();
+        while (!innings1.isInningsComplete()) {
+            innings1.playBall();
+            co_await suspend_always{};
+        }
+        publish(GameEvent::INNINGS_END, 0, innings1.getState(), 0);
+        
+        while (!innings2.isInningsComplete()) {
+            innings2.playBall();
+            co_await suspend_always{};
+        }
+        finishMatch();
+    }
+#endif
+    
+    void startMatch() {
+        publish(GameEvent::MATCH_START, 0, innings1.getState(), 0);
+    }
+    
+    void finishMatch() {
+        SimStats::add(Counter::MATCHES);
+        SimStats::add(Counter::INNINGS, 2);
+        publish(GameEvent::INNINGS_END, 1, innings2.getState(), 0);
+        
+        if (archive) {
+            archive->appendMatch(PackedInnings::withTeams(innings1.getPackedRecord(), team1Index, team2Index),
+                                 PackedInnings::withTeams(innings2.getPackedRecord(), team2Index, team1Index));
+        }
+        
+        determineResult();
+        playerOfMatch = calculatePlayerOfMatch();
+        publish(GameEvent::MATCH_END, 1, innings2.getState(), (uint8_t)result);
+    }
+    
+    // Replay a logged match through the normal scoring and commentary code
+    void replay(const MappedBallLog& log, const MatchIndexEntry& entry) {
+        publish(GameEvent::MATCH_START, 0, innings1.getState(), 1);
+        
+        uint32_t i = 0;
+        for (; i < entry.eventCount && log.event(entry.firstEvent + i).innings == 0; i++) {
+            innings1.replayBall(log.event(entry.firstEvent + i));
+        }
+        publish(GameEvent::INNINGS_END, 0, innings1.getState(), 0);
+        
+        for (; i < entry.eventCount; i++) {
+            innings2.replayBall(log.event(entry.firstEvent + i));
+        }
+        publish(GameEvent::INNINGS_END, 1, innings2.getState(), 0);
+        
+        SimStats::add(Counter::MATCHES);
+        SimStats::add(Counter::INNINGS, 2);
+        determineResult();
+        playerOfMatch = calculatePlayerOfMatch();
+        publish(GameEvent::MATCH_END, 1, innings2.getState(), (uint8_t)result);
+    }
+    
+    void publish(GameEvent::Kind kind, uint8_t innings, const InningsState& state, uint8_t detail) {
+        if (!bus || bus->empty()) return;
+        GameEvent event = {};
+        event.kind = kind;
+        event.innings = innings;
+        event.detail = detail;
+        event.matchId = matchId;
+        event.state = state;
+        bus->publish(event);
+    }
+    
+    void determineResult() {
+        int score1 = innings1.getTotalRuns();
+        int score2 = innings2.getTotalRuns();
+        
+        if (score1 > score2) {
+            result = MatchResult::WIN;
+            team1->updateMatchResult(MatchResult::WIN);
+            team2->updateMatchResult(MatchResult::LOSS);
+            team1->addPoints(2);
+        } else if (score2 > score1) {
+            result = MatchResult::LOSS;
+            team1->updateMatchResult(MatchResult::LOSS);
+            team2->updateMatchResult(MatchResult::WIN);
+            team2->addPoints(2);
+        } else {
+            result = MatchResult::TIE;
+            team1->updateMatchResult(MatchResult::TIE);
+            team2->updateMatchResult(MatchResult::TIE);
+            team1->addPoints(1);
+            team2->addPoints(1);
+        }
+    }
+    
+    shared_ptr<Player> calculatePlayerOfMatch() {
+        auto player1 = innings1.getPlayerOfInnings();
+        auto player2 = innings2.getPlayerOfInnings();
+        
+        if (player1->getMatchCredits() > player2->getMatchCredits()) {
+            return player1;
+        } else {
+            return player2;
+        }
+    }
+    
+    // Getters
+    MatchResult getResult() const { return result; }
+    shared_ptr<Player> getPlayerOfMatch() const { return playerOfMatch; }
+    uint32_t getMatchId() const { return matchId; }
+    Team* getTeam1() const { return team1; }
+    Team* getTeam2() const { return team2; }
+    const Innings& getFirstInnings() const { return innings1; }
+    const Innings& getSecondInnings() const { return innings2; }
+    const string& getVenue() const { return venue; }
+    const string& getDate() const { return date; }
+    
+    // Snapshot for what-if forks; valid at any ball
+    MatchState snapshot() const {
+        MatchState s;
+        s.innings[0] = innings1.getState();
+        s.innings[1] = innings2.getState();
+        return s;
+    }
+    
+    Team* getWinner() const {
+        if (result == MatchResult::WIN) return team1;
+        else if (result == MatchResult::LOSS) return team2;
+        return nullptr;  // Tie or no result
+    }
+};
+
+// Forwards to another stream buffer, counting the bytes as commentary output
+class CountingStreambuf : public streambuf {
+private:
+    streambuf* target;
+    
+protected:
+    int_type overflow(int_type c) override {
+        if (traits_type::eq_int_type(c, traits_type::eof())) return traits_type::not_eof(c);
+        SimStats::add(Counter::COMMENTARY_BYTES);
+        return target->sputc(traits_type::to_char_type(c));
+    }
+    
+    streamsize xsputn(const char* s, streamsize n) override {
+        SimStats::add(Counter::COMMENTARY_BYTES, (uint64_t)n);
+        return target->sputn(s, n);
+    }
+    
+    int sync() override {
+        TraceSpan span("commentaryFlush");
+        return target->pubsync();
+    }
+    
+public:
+    explicit CountingStreambuf(streambuf* t) : target(t) {}
+    
+    void setTarget(streambuf* t) { target = t; }
+};
+
+/*
+Ball commentary from fixed fragments. Each outcome has a few phrasings
+split around the striker's name (and, for a wicket, the bowler's); a line
+is assembled in a caller's fixed buffer with hand-rolled integer
+formatting, so formatting touches no iostream, locale or heap. Variant 0
+is the standard commentary.
+*/
+class CommentaryFormatter {
+public:
+    static const int VARIANTS = 3;
+    static const size_t MAX_NAME = 64;      // longer names are cut
+    static const size_t MAX_LINE = 256;
+    
+private:
+    // lead + striker + middle [+ bowler + tail for a wicket] + newline
+    struct Phrase {
+        string_view lead;
+        string_view middle;
+        string_view tail;
+    };
+    
+    // Indexed by BallOutcome, then variant
+    static constexpr Phrase phrases[7][VARIANTS] = {
+        {{"Dot ball. ", " defends", ""}, {"No run. ", " leaves it alone", ""},
+         {"Dot ball. Tight line, ", " can't get it away", ""}},
+        {{"Single. ", " takes a quick run", ""}, {"One run. ", " nudges it to the on side", ""},
+         {"Single. ", " works it into the gap", ""}},
+        {{"Two runs. ", " pushes for a couple", ""}, {"Two more. ", " comes back for the second", ""},
+         {"Two runs. ", " drives into the deep", ""}},
+        {{"Three runs. ", " runs hard for three", ""}, {"Three. ", " finds the gap and they run three", ""},
+         {"Three runs. Excellent running from ", "", ""}},
+        {{"FOUR! ", " hits a boundary!", ""}, {"FOUR! ", " pierces the field!", ""},
+         {"FOUR! Cracking shot from ", "!", ""}},
+        {{"SIX! ", " hits it out of the park!", ""}, {"SIX! ", " launches it into the stands!", ""},
+         {"SIX! Huge hit from ", "!", ""}},
+        {{"WICKET! ", " is out! Bowled by ", ""}, {"WICKET! ", " has to go, ", " strikes!"},
+         {"WICKET! ", " is gone! A big moment for ", ""}},
+    };
+    
+    // A plain variable-length memcpy; clamping inside would make the
+    // compiler expand it inline, which is several times slower
+    static char* append(char* p, string_view text) {
+        memcpy(p, text.data(), text.size());
+        return p + text.size();
+    }
+    
+    static char* appendInt(char* p, int value) {
+        if (value < 0) {
+            *p++ = '-';
+            value = -value;
+        }
+        char digits[10];
+        int n = 0;
+        do {
+            digits[n++] = (char)('0' + value % 10);
+            value /= 10;
+        } while (value > 0);
+        while (n > 0) *p++ = digits[--n];
+        return p;
+    }
+    
+public:
+    // One ball: the delivery line, then the score as it stood when the ball
+    // was bowled. Writes at most MAX_LINE bytes; returns the length.
+    static size_t formatBall(const GameEvent& e, string_view striker, string_view bowler, int variant, char* line) {
+        const InningsState& s = e.state;
+        const Phrase& phrase = phrases[e.outcome][variant];
+        char* p = line;
+        
+        p = append(p, "Ball ");
+        p = appendInt(p, s.balls);
+        p = append(p, ": ");
+        p = append(p, phrase.lead);
+        p = append(p, striker.substr(0, MAX_NAME));
+        p = append(p, phrase.middle);
+        if ((BallOutcome)e.outcome == BallOutcome::WICKET) {
+            p = append(p, bowler.substr(0, MAX_NAME));
+            p = append(p, phrase.tail);
+        }
+        *p++ = '\n';
+        
+        int overs = s.overBalls == 0 ? s.overs - 1 : s.overs;
+        int overBalls = s.overBalls == 0 ? 5 : s.overBalls - 1;
+        p = append(p, "Score: ");
+        p = appendInt(p, s.runs);
+        *p++ = '/';
+        p = appendInt(p, s.wickets);
+        p = append(p, " (");
+        p = appendInt(p, overs);
+        *p++ = '.';
+        p = appendInt(p, overBalls);
+        p = append(p, ")\n\n");
+        return (size_t)(p - line);
+    }
+};
+
+// Console commentary, driven entirely by bus events. Names are resolved
+// against the tournament's fixtures and players (ids index the player list).
+class CommentaryPrinter : public EventSubscriber {
+private:
+    const vector<Match*>& matches;
+    const vector<shared_ptr<Player>>& players;
+    const Match* current;
+    
+    CountingStreambuf counter;
+    ostream out;
+    
+    // Varied phrasing draws from its own generator, reseeded per match, so
+    // it never disturbs the simulation's outcomes
+    bool varied;
+    ForkRandom phrasing;
+    
+    string_view playerName(uint32_t id) const {
+        return id < players.size() ? players[id]->getName() : string_view("?");
+    }
+    
+    // Ball lines skip the ostream: they are formatted into a fixed buffer and
+    // written straight to the stream buffer, unflushed
+    void printBall(const GameEvent& e) {
+        char line[CommentaryFormatter::MAX_LINE];
+        int variant = varied ? (int)(phrasing.next() % CommentaryFormatter::VARIANTS) : 0;
+        size_t length = CommentaryFormatter::formatBall(e, playerName(e.onStrikeId), playerName(e.bowlerId), variant, line);
+        counter.sputn(line, (streamsize)length);
+    }
+    
+    void printSummary(const GameEvent& e) {
+        const Innings& first = current->getFirstInnings();
+        const Innings& second = current->getSecondInnings();
+        MatchResult result = (MatchResult)e.detail;
+        
+        out << "\n=== MATCH SUMMARY ===" << endl;
+        out << current->getTeam1()->getName() << ": " << first.getTotalRuns() << "/" << first.getTotalWickets() << endl;
+        out << current->getTeam2()->getName() << ": " << second.getTotalRuns() << "/" << second.getTotalWickets() << endl;
+        
+        if (result == MatchResult::WIN) {
+            out << "Result: " << current->getTeam1()->getName() << " won!" << endl;
+        } else if (result == MatchResult::LOSS) {
+            out << "Result: " << current->getTeam2()->getName() << " won!" << endl;
+        } else {
+            out << "Result: Match tied!" << endl;
+        }
+        
+        out << "Player of the Match: " << current->getPlayerOfMatch()->getName() << endl;
+        out << "=========================================" << endl << endl;
+    }
+    
+public:
+    CommentaryPrinter(const vector<Match*>& m, const vector<shared_ptr<Player>>& p) :
+        matches(m), players(p), current(nullptr), counter(cout.rdbuf()), out(&counter), varied(false), phrasing{0} {}
+    
+    void setVaried(bool v) { varied = v; }
+    
+    // Defaults to cout
+    void setOutput(streambuf* target) { counter.setTarget(target); }
+    
+    void onEvent(const GameEvent& e) override {
+        if (e.kind == GameEvent::MATCH_START) {
+            phrasing.state = e.matchId;
+            current = nullptr;
+            for (const auto& match : matches) {
+                if (match->getMatchId() == e.matchId) current = match;
+            }
+        }
+        if (!current) return;
+        const string& team1 = current->getTeam1()->getName();
+        const string& team2 = current->getTeam2()->getName();
+        
+        switch (e.kind) {
+            case GameEvent::MATCH_START:
+                if (e.detail) {
+                    out << "\n=== REPLAY: " << team1 << " vs " << team2 << " ===" << endl;
+                } else {
+                    out << "\n=== " << team1 << " vs " << team2 << " ===" << endl;
+                    out << "Venue: " << current->getVenue() << " | Date: " << current->getDate() << endl << endl;
+                }
+                out << "=== FIRST INNINGS: " << team1 << " batting ===" << endl;
+                break;
+            case GameEvent::BALL:
+                printBall(e);
+                break;
+            case GameEvent::INNINGS_END:
+                if (e.innings == 0) {
+                    out << "First innings complete! " << team1 << " scored " 
+                         << e.state.runs << "/" << (int)e.state.wickets << endl << endl;
+                    out << "=== SECOND INNINGS: " << team2 << " batting ===" << endl;
+                } else {
+                    out << "Second innings complete! " << team2 << " scored " 
+                         << e.state.runs << "/" << (int)e.state.wickets << endl << endl;
+                }
+                break;
+            case GameEvent::MATCH_END:
+                printSummary(e);
+                break;
+            default:
+                break;
+        }
+    }
+};
+
+// In-memory commentary for one unit of work; see CommentaryArchive
+class CommentaryRegion : public streambuf {
+private:
+    vector<char> bytes;
+    
+protected:
+    int_type overflow(int_type c) override {
+        if (traits_type::eq_int_type(c, traits_type::eof())) return traits_type::not_eof(c);
+        bytes.push_back(traits_type::to_char_type(c));
+        return c;
+    }
+    
+    streamsize xsputn(const char* s, streamsize n) override {
+        bytes.insert(bytes.end(), s, s + n);
+        return n;
+    }
+    
+public:
+    // Hands the bytes over; the next region starts with the same capacity
+    vector<char> take() {
+        vector<char> full;
+        full.reserve(bytes.capacity());
+        full.swap(bytes);
+        return full;
+    }
+};
+
+/*
+Commentary archive for long batch runs. Each worker writes a season's
+commentary into its own CommentaryRegion and submits it with the season's
+sequence number; regions are appended to a MappedAppendFile strictly in
+sequence, so the file is the same whatever the thread count and no worker
+ever makes a write call.
+*/
+class CommentaryArchive {
+private:
+    MappedAppendFile file;
+    mutex lock;
+    map<uint64_t, vector<char>> pending;
+    uint64_t nextSequence;
+    bool failed;
+    
+public:
+    CommentaryArchive() : nextSequence(0), failed(false) {}
+    
+    bool open(const string& path) {
+        nextSequence = 0;
+        failed = false;
+        pending.clear();
+        return file.open(path);
+    }
+    
+    // Early regions wait until every region before them has arrived. False
+    // once a write has failed; later regions are dropped.
+    bool submit(uint64_t sequence, vector<char>&& region) {
+        lock_guard<mutex> guard(lock);
+        if (failed) return false;
+        pending.emplace(sequence, move(region));
+        for (auto it = pending.begin(); it != pending.end() && it->first == nextSequence; it = pending.erase(it)) {
+            if (!file.append(it->second.data(), it->second.size())) {
+                failed = true;
+                pending.clear();
+                return false;
+            }
+            nextSequence++;
+        }
+        return true;
+    }
+    
+    // False if a region is missing or a write failed
+    bool close() {
+        lock_guard<mutex> guard(lock);
+        bool complete = pending.empty();
+        pending.clear();
+        return file.close() && complete && !failed;
+    }
+    
+    uint64_t size() const { return file.size(); }
+};
+
+#if defined(__cpp_impl_coroutine)
+/*
+Match-day scheduler: interleaves many match coroutines on a few threads in
+simulated time. Every tick resumes each live match once (one ball), and a
+barrier ends the tick on all threads, so ball k of every match is bowled in
+tick k. Matches are split across threads in contiguous blocks; a match
+never migrates, so its events stay in order on one thread.
+*/
+class MatchDay {
+private:
+    vector<MatchTask> tasks;
+    
+public:
+    void add(MatchTask task) { tasks.push_back(move(task)); }
+    
+    // Worker t runs tasks [firstTask(t), firstTask(t + 1)), where threads is
+    // already clamped to the task count as run() does
+    static size_t firstTask(size_t count, unsigned t, unsigned threads) { return count * t / threads; }
+    
+    // onTick(thread, tick) runs on each worker before its matches bowl that tick.
+    // Returns the number of ticks.
+    template <typename OnTick>
+    uint64_t run(unsigned threads, OnTick onTick) {
+        threads = max(1u, min<unsigned>(threads, (unsigned)max<size_t>(1, tasks.size())));
+        atomic<size_t> live(tasks.size());
+        uint64_t ticks = 0;
+        
+        // Termination is decided once per tick, in the completion step, so
+        // every worker sees the same answer and arrives the same number of times
+        bool finished = tasks.empty();
+        barrier sync((ptrdiff_t)threads, [&]() noexcept {
+            ticks++;
+            finished = live.load(memory_order_acquire) == 0;
+        });
+        
+        auto worker = [&](unsigned t) {
+            size_t first = firstTask(tasks.size(), t, threads);
+            size_t last = firstTask(tasks.size(), t + 1, threads);
+            for (uint64_t tick = 0; !finished; tick++) {
+                TraceSpan span("tick", "tick", (int64_t)tick);
+                onTick(t, tick);
+                for (size_t i = first; i < last; i++) {
+                    if (!tasks[i].done() && !tasks[i].resume()) live.fetch_sub(1, memory_order_acq_rel);
+                }
+                sync.arrive_and_wait();
+            }
+        };
+        
+        vector<thread> workers;
+        for (unsigned t = 1; t < threads; t++) workers.emplace_back(worker, t);
+        worker(0);
+        for (auto& w : workers) w.join();
+        return ticks;
+    }
+    
+    size_t size() const { return tasks.size(); }
+};
+#endif
+
+// Header of a tournament checkpoint file
+struct CheckpointHeader {
+    char magic[8];         // "IPLCKPT1"
+    uint32_t version;
+    uint32_t checksum;     // CRC-32C of the payload
+    uint64_t payloadSize;
+};
+
+// Tournament class
+class Tournament {
+private:
+    string name;
+    vector<shared_ptr<Team>> teams;
+    vector<shared_ptr<Player>> allPlayers;
+    PlayerPool playerPool;
+    
+    // Fixtures (and their innings) live in the arena for the whole tournament
+    Arena arena;
+    vector<Match*> matches;
+    
+    int currentRound;
+    bool isCompleted;
+    
+    // Batch-run settings
+    bool interactive;
+    bool verbose;
+    uint32_t firstMatchId;
+    PackedArchive* archive;
+    ScoreStream* stream;
+    
+    // Every fixture publishes here; commentary and the ball log subscribe
+    EventBus bus;
+    CommentaryPrinter commentary;
+    BallLogSubscriber logWriter;
+    
+    // All ball outcomes are drawn from this engine so a checkpoint can capture it
+    mt19937 rng;
+    string checkpointPath;
+    
+    shared_ptr<Player> makePlayer(PlayerType type, const string& name, int age) {
+        return playerPool.make(type, name, age);
+    }
+    
+    void addFixture(Team* t1, Team* t2, int i, int j) {
+        Match* match = arena.make<Match>(t1, t2, "Home Ground", "Today");
+        match->setMatchId(firstMatchId + (uint32_t)matches.size());
+        match->setRandom(&rng);
+        match->attachBus(&bus);
+        if (archive) match->attachArchive(archive, i, j);
+        matches.push_back(match);
+    }
+    
+    int teamIndex(const Team* team) const {
+        for (size_t i = 0; i < teams.size(); i++) {
+            if (teams[i].get() == team) return (int)i;
+        }
+        return -1;
+    }
+    
+public:
+    Tournament(const string& n) : name(n), currentRound(0), isCompleted(false),
+        interactive(true), verbose(true), firstMatchId(0), archive(nullptr), stream(nullptr),
+        commentary(matches, allPlayers), rng(random_device{}()) {
+        bus.subscribe(&commentary);
+    }
+    
+    Tournament(const Tournament&) = delete;
+    Tournament& operator=(const Tournament&) = delete;
+    
+    void setSeed(uint32_t seed) { rng.seed(seed); }
+    
+    // A checkpoint is written atomically after every round
+    void setCheckpointPath(const string& path) { checkpointPath = path; }
+    
+    // Non-interactive runs use default openers and skip the setup prompts
+    void setInteractive(bool i) { interactive = i; }
+    void setVerbose(bool v) {
+        verbose = v;
+        if (v) bus.subscribe(&commentary);
+        else bus.unsubscribe(&commentary);
+    }
+    
+    void setVariedCommentary(bool v) { commentary.setVaried(v); }
+    
+    // Commentary (only) goes to the given buffer, whatever the verbosity
+    void attachCommentary(streambuf* target) {
+        commentary.setOutput(target);
+        bus.subscribe(&commentary);
+    }
+    
+    // Every delivery is appended to the log; match ids continue from firstId
+    void attachBallLog(BallLog* log, uint32_t firstId) {
+        firstMatchId = firstId;
+        if (!log) return;
+        logWriter = BallLogSubscriber(log);
+        bus.subscribe(&logWriter);
+    }
+    
+    void attachArchive(PackedArchive* a) { archive = a; }
+    
+    // Ball events and the points table after each match go to the stream
+    void attachStream(ScoreStream* s) {
+        stream = s;
+        if (s) bus.subscribe(s);
+    }
+    
+    // Tournament management
+    void addTeam(shared_ptr<Team> team) {
+        teams.push_back(team);
+    }
+    
+    void generateFixtures() {
+        PhaseTimer timer(Counter::SETUP_NS);
+        TraceSpan span("generateFixtures");
+        // Round-robin: each team plays every other team
+        for (int i = 0; i < teams.size(); i++) {
+            for (int j = i + 1; j < teams.size(); j++) {
+                addFixture(teams[i].get(), teams[j].get(), i, j);
+            }
+        }
+    }
+    
+    void playRound() {
+        if (currentRound < matches.size()) {
+            if (verbose) cout << "\n=== ROUND " << (currentRound + 1) << " ===" << endl;
+            if (interactive) matches[currentRound]->setupInnings();
+            matches[currentRound]->playMatch();
+            if (stream) {
+                int points[StreamEvent::MAX_TEAMS];
+                size_t count = min<size_t>(teams.size(), StreamEvent::MAX_TEAMS);
+                for (size_t t = 0; t < count; t++) points[t] = teams[t]->getPoints();
+                stream->publishStandings(matches[currentRound]->getMatchId(), points, count);
+            }
+            currentRound++;
+            
+            if (!checkpointPath.empty() && !saveCheckpoint(checkpointPath)) {
+                cerr << "Cannot write checkpoint " << checkpointPath << endl;
+            }
+        }
+    }
+    
+    void playTournament() {
+        PhaseTimer timer(Counter::PLAY_NS);
+        TraceSpan span("playTournament");
+        if (verbose) {
+            if (currentRound == 0) cout << "\n=== TOURNAMENT BEGINS ===" << endl;
+            else cout << "\n=== TOURNAMENT RESUMES AT ROUND " << (currentRound + 1) << " ===" << endl;
+        }
+        while (currentRound < (int)matches.size()) {
+            playRound();
+        }
+        isCompleted = true;
+    }
+    
+    /*
+    Checkpoint layout: [CheckpointHeader][payload]. The payload holds the tournament counters, the RNG
+    state, every player (type, name, age, stats), every team (state, roster ids) and
+    every fixture (team indices, match id, result and innings state once played).
+    */
+    bool saveCheckpoint(const string& path) const {
+        TraceSpan span("saveCheckpoint");
+        BinaryWriter out;
+        out.putString(name);
+        out.put(currentRound);
+        out.put(isCompleted);
+        out.put(interactive);
+        out.put(firstMatchId);
+        
+        ostringstream rngState;
+        rngState << rng;
+        out.putString(rngState.str());
+        
+        out.put((uint32_t)allPlayers.size());
+        for (const auto& player : allPlayers) {
+            out.put(player->getType());
+            out.putString(player->getName());
+            out.put(player->getAge());
+            player->saveState(out);
+        }
+        
+        out.put((uint32_t)teams.size());
+        for (const auto& team : teams) {
+            out.putString(team->getName());
+            out.putString(team->getCity());
+            team->saveState(out);
+            out.put((uint32_t)team->getRoster().size());
+            for (const auto& player : team->getRoster()) out.put(player->getId());
+        }
+        
+        out.put((uint32_t)matches.size());
+        for (const auto& match : matches) {
+            out.put(teamIndex(match->getTeam1()));
+            out.put(teamIndex(match->getTeam2()));
+            out.put(match->getMatchId());
+            match->saveState(out);
+        }
+        
+        const vector<char>& payload = out.data();
+        CheckpointHeader header;
+        memcpy(header.magic, "IPLCKPT1", 8);
+        header.version = 3;  // 2: innings saved as InningsState; 3: compact all-rounder figures
+        header.checksum = Crc32c::compute(payload.data(), payload.size());
+        header.payloadSize = payload.size();
+        
+        vector<char> bytes(sizeof(header) + payload.size());
+        memcpy(bytes.data(), &header, sizeof(header));
+        memcpy(bytes.data() + sizeof(header), payload.data(), payload.size());
+        return FileSync::writeAtomically(path, bytes.data(), bytes.size());
+    }
+    
+    // Rebuild a tournament from a checkpoint; call on a freshly constructed object
+    // after choosing verbosity and attaching logs
+    bool loadCheckpoint(const string& path) {
+        ifstream in(path, ios::binary);
+        if (!in) return false;
+        vector<char> bytes((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+        CheckpointHeader header;
+        if (bytes.size() < sizeof(header)) return false;
+        memcpy(&header, bytes.data(), sizeof(header));
+        const char* payload = bytes.data() + sizeof(header);
+        if (memcmp(header.magic, "IPLCKPT1", 8) != 0 || header.version != 3 || header.payloadSize != bytes.size() - sizeof(header) ||
+            header.checksum != Crc32c::compute(payload, header.payloadSize)) {
+            return false;
+        }
+        
+        BinaryReader reader(payload, header.payloadSize);
+        name = reader.getString();
+        currentRound = reader.get<int>();
+        isCompleted = reader.get<bool>();
+        interactive = reader.get<bool>();
+        firstMatchId = reader.get<uint32_t>();
+        
+        istringstream rngState(reader.getString());
+        rngState >> rng;
+        
+        allPlayers.clear();
+        uint32_t playerCount = reader.get<uint32_t>();
+        for (uint32_t i = 0; i < playerCount && reader.ok(); i++) {
+            PlayerType type = reader.get<PlayerType>();
+            string playerName = reader.getString();
+            int age = reader.get<int>();
+            auto player = makePlayer(type, playerName, age);
+            player->setId(i);
+            player->loadState(reader);
+            allPlayers.push_back(player);
+        }
+        
+        teams.clear();
+        uint32_t teamCount = reader.get<uint32_t>();
+        for (uint32_t i = 0; i < teamCount && reader.ok(); i++) {
+            string teamName = reader.getString();
+            string city = reader.getString();
+            auto team = make_shared<Team>(teamName, city);
+            team->loadState(reader);
+            uint32_t rosterSize = reader.get<uint32_t>();
+            for (uint32_t r = 0; r < rosterSize; r++) {
+                uint32_t id = reader.get<uint32_t>();
+                if (id >= allPlayers.size()) return false;
+                team->addPlayer(allPlayers[id]);
+            }
+            team->selectPlaying5();
+            teams.push_back(team);
+        }
+        
+        matches.clear();
+        arena.reset();
+        uint32_t matchCount = reader.get<uint32_t>();
+        for (uint32_t m = 0; m < matchCount && reader.ok(); m++) {
+            int i = reader.get<int>();
+            int j = reader.get<int>();
+            uint32_t matchId = reader.get<uint32_t>();
+            if (i < 0 || j < 0 || i >= (int)teams.size() || j >= (int)teams.size()) return false;
+            addFixture(teams[i].get(), teams[j].get(), i, j);
+            matches.back()->setMatchId(matchId);
+            matches.back()->loadState(reader, allPlayers);
+        }
+        
+        return reader.ok();
+    }
+    
+    // User input methods
+    void createTeams() {
+        PhaseTimer timer(Counter::SETUP_NS);
+        TraceSpan span("createTeams");
+        string teamNames[] = {"Mumbai Indians", "Chennai Super Kings", "Royal Challengers", "Kolkata Knight Riders"};
+        string cities[] = {"Mumbai", "Chennai", "Bangalore", "Kolkata"};
+        
+        for (int i = 0; i < 4; i++) {
+            auto team = make_shared<Team>(teamNames[i], cities[i]);
+            addTeam(team);
+        }
+    }
+    
+    void createPlayers() {
+        TraceSpan span("createPlayers");
+        // Create players for each team
+        for (auto& team : teams) {
+            cout << "\nCreating players for " << team->getName() << ":" << endl;
+            
+            for (int i = 0; i < 5; i++) {
+                string name, typeStr;
+                int age, typeChoice;
+                
+                cout << "Player " << (i + 1) << " name: ";
+                cin >> name;
+                cout << "Player " << (i + 1) << " age: ";
+                cin >> age;
+                cout << "Player " << (i + 1) << " type (1-Batsman, 2-Bowler, 3-AllRounder): ";
+                cin >> typeChoice;
+                
+                PlayerType type = typeChoice == 2 ? PlayerType::BOWLER
+                                : typeChoice == 3 ? PlayerType::ALLROUNDER
+                                : PlayerType::BATSMAN;
+                shared_ptr<Player> player = makePlayer(type, name, age);
+                
+                player->setId((uint32_t)allPlayers.size());
+                team->addPlayer(player);
+                allPlayers.push_back(player);
+            }
+            
+            team->selectPlaying5();
+        }
+    }
+    
+    // Generated rosters for batch runs: 2 batsmen, 2 bowlers and 1 all-rounder per team
+    void createDefaultPlayers() {
+        PhaseTimer timer(Counter::SETUP_NS);
+        TraceSpan span("createDefaultPlayers");
+        const PlayerType roles[] = {PlayerType::BATSMAN, PlayerType::BATSMAN, PlayerType::BOWLER,
+                                    PlayerType::ALLROUNDER, PlayerType::BOWLER};
+        
+        for (size_t t = 0; t < teams.size(); t++) {
+            for (int i = 0; i < 5; i++) {
+                string name = "T" + to_string(t + 1) + "P" + to_string(i + 1);
+                shared_ptr<Player> player = makePlayer(roles[i], name, 25);
+                
+                player->setId((uint32_t)allPlayers.size());
+                teams[t]->addPlayer(player);
+                allPlayers.push_back(player);
+            }
+            
+            teams[t]->selectPlaying5();
+        }
+    }
+    
+    size_t getMatchCount() const { return matches.size(); }
+    int getCurrentRound() const { return currentRound; }
+    
+    // Replay match k of a log; ids wrap per season for multi-season batch logs
+    bool replayMatch(const MappedBallLog& log, uint64_t k) {
+        if (k >= log.getMatchCount() || matches.empty()) return false;
+        const MatchIndexEntry& entry = log.getMatch(k);
+        matches[(entry.matchId - firstMatchId) % matches.size()]->replay(log, entry);
+        return true;
+    }
+    
+    // Statistics and results
+    vector<shared_ptr<Team>> getPointsTable() const {
+        auto sortedTeams = teams;
+        sort(sortedTeams.begin(), sortedTeams.end(), 
+             [](const auto& a, const auto& b) { return a->getPoints() > b->getPoints(); });
+        return sortedTeams;
+    }
+    
+    shared_ptr<Player> getPlayerOfTournament() const {
+        shared_ptr<Player> bestPlayer = nullptr;
+        int maxCredits = -1;
+        
+        for (const auto& player : allPlayers) {
+            if (player->getTotalCredits() > maxCredits) {
+                maxCredits = player->getTotalCredits();
+                bestPlayer = player;
+            }
+        }
+        
+        return bestPlayer;
+    }
+    
+    shared_ptr<Team> getChampion() const {
+        auto pointsTable = getPointsTable();
+        return pointsTable.empty() ? nullptr : pointsTable[0];
+    }
+    
+    // Getters
+    const string& getName() const { return name; }
+    bool getIsCompleted() const { return isCompleted; }
+    const vector<shared_ptr<Team>>& getTeams() const { return teams; }
+    const vector<Match*>& getMatches() const { return matches; }
+    const vector<shared_ptr<Player>>& getPlayers() const { return allPlayers; }
+    
+    // Display methods
+    void displayTeams() {
+        cout << "\n=== TOURNAMENT TEAMS ===" << endl;
+        for (const auto& team : teams) {
+            cout << team->getName() << " (" << team->getLineup().size() << " players)" << endl;
+        }
+        cout << "=========================" << endl;
+    }
+    
+    void displayPlayerStats() {
+        TraceSpan span("displayPlayerStats");
+        cout << "\n=== FINAL PLAYER STATISTICS ===" << endl;
+        cout << setw(20) << "Name" << setw(10) << "Runs" << setw(10) << "Balls" << setw(10) << "Wickets" << setw(10) << "Credits" << endl;
+        cout << "------------------------------------------------------------" << endl;
+        
+        for (const auto& player : allPlayers) {
+            cout << setw(20) << player->getName() 
+                 << setw(10) << player->getTotalRunsScored()
+                 << setw(10) << player->getTotalBallsFaced()
+                 << setw(10) << player->getTotalWicketsTaken()
+                 << setw(10) << player->getTotalCredits() << endl;
+        }
+        
+        cout << "\n=== FINAL POINTS TABLE ===" << endl;
+        auto pointsTable = getPointsTable();
+        for (int i = 0; i < pointsTable.size(); i++) {
+            cout << (i + 1) << ". " << setw(25) << pointsTable[i]->getName() 
+                 << " - " << pointsTable[i]->getPoints() << " points" << endl;
+        }
+        
+        auto champion = getChampion();
+        auto playerOfTournament = getPlayerOfTournament();
+        
+        cout << "\n=== TOURNAMENT AWARDS ===" << endl;
+        cout << "Champion: " << champion->getName() << endl;
+        cout << "Player of the Tournament: " << playerOfTournament->getName() << endl;
+    }
+};
+
+// Statistics and utility classes
+class Statistics {
+public:
+    static shared_ptr<Player> getPlayerOfMatch(const vector<shared_ptr<Player>>& players) {
+        shared_ptr<Player> bestPlayer = nullptr;
+        int maxCredits = -1;
+        
+        for (const auto& player : players) {
+            if (player->getMatchCredits() > maxCredits) {
+                maxCredits = player->getMatchCredits();
+                bestPlayer = player;
+            }
+        }
+        
+        return bestPlayer;
+    }
+    
+    static shared_ptr<Player> getPlayerOfTournament(const vector<shared_ptr<Player>>& players) {
+        shared_ptr<Player> bestPlayer = nullptr;
+        int maxCredits = -1;
+        
+        for (const auto& player : players) {
+            if (player->getTotalCredits() > maxCredits) {
+                maxCredits = player->getTotalCredits();
+                bestPlayer = player;
+            }
+        }
+        
+        return bestPlayer;
+    }
+    
+    static vector<shared_ptr<Team>> sortTeamsByPoints(const vector<shared_ptr<Team>>& teams) {
+        auto sortedTeams = teams;
+        sort(sortedTeams.begin(), sortedTeams.end(), 
+             [](const auto& a, const auto& b) { return a->getPoints() > b->getPoints(); });
+        return sortedTeams;
+    }
+};
+
+// A fixture result forced by a scenario; winner is a team index, -1 for a tie
+struct ForcedResult {
+    int fixture;
+    int winner;
+};
+
+struct Scenario {
+    string label;
+    vector<ForcedResult> forced;
+    
+    const ForcedResult* find(int fixture) const {
+        for (const auto& f : forced) {
+            if (f.fixture == fixture) return &f;
+        }
+        return nullptr;
+    }
+};
+
+// Team points. Copies share one table until a copy records a result
+// (copy-on-write), so branching a season costs a pointer copy.
+class Standings {
+private:
+    shared_ptr<vector<int>> points;
+    
+    vector<int>& mutablePoints() {
+        if (points.use_count() > 1) points = make_shared<vector<int>>(*points);
+        return *points;
+    }
+    
+public:
+    Standings() : points(make_shared<vector<int>>()) {}
+    explicit Standings(vector<int> initial) : points(make_shared<vector<int>>(move(initial))) {}
+    
+    void record(int team1, int team2, int winner) {
+        vector<int>& p = mutablePoints();
+        if (winner < 0) {
+            p[team1]++;
+            p[team2]++;
+        } else {
+            p[winner] += 2;
+        }
+    }
+    
+    // Champion: most points, earlier team on a tie
+    int leader() const {
+        int best = 0;
+        for (int t = 1; t < (int)points->size(); t++) {
+            if ((*points)[t] > (*points)[best]) best = t;
+        }
+        return best;
+    }
+    
+    int getPoints(int team) const { return (*points)[team]; }
+    size_t size() const { return points->size(); }
+};
+
+/*
+Scenario sweeps over the rest of a season. Fixtures before the first one any
+scenario forces are the shared prefix: each run simulates them once, then
+every scenario branches from that standings snapshot and only plays the
+suffix. Matches are simulated from MatchState like the what-if forks.
+*/
+class ScenarioEngine {
+private:
+    struct Fixture {
+        int team1;
+        int team2;
+    };
+    
+    vector<Fixture> fixtures;
+    vector<string> teamNames;
+    int played;
+    Standings base;
+    vector<Scenario> scenarios;
+    
+    int simulateWinner(const Fixture& f, ForkRandom& random, uint64_t& simulated) const {
+        MatchState m;
+        m.innings[0] = InningsState::opening(5, 5);
+        m.innings[1] = InningsState::opening(5, 5);
+        WhatIf::playOut(m, random);
+        simulated++;
+        
+        if (m.innings[0].runs > m.innings[1].runs) return f.team1;
+        if (m.innings[1].runs > m.innings[0].runs) return f.team2;
+        return -1;
+    }
+    
+    void playFixtures(Standings& standings, int first, int last, const Scenario* scenario,
+                      ForkRandom& random, uint64_t& simulated) const {
+        for (int i = first; i < last; i++) {
+            const ForcedResult* forced = scenario ? scenario->find(i) : nullptr;
+            int winner = forced ? forced->winner : simulateWinner(fixtures[i], random, simulated);
+            standings.record(fixtures[i].team1, fixtures[i].team2, winner);
+        }
+    }
+    
+public:
+    struct Result {
+        uint64_t runs = 0;
+        uint64_t simulated = 0;                 // matches played out
+        vector<vector<uint64_t>> champions;     // [scenario][team] -> titles
+    };
+    
+    ScenarioEngine() : played(0) {}
+    
+    // Fixtures and standings of a tournament; played rounds are fixed
+    void load(const Tournament& tournament) {
+        const auto& teams = tournament.getTeams();
+        auto indexOf = [&](const Team* team) {
+            for (size_t t = 0; t < teams.size(); t++) {
+                if (teams[t].get() == team) return (int)t;
+            }
+            return -1;
+        };
+        
+        fixtures.clear();
+        for (const auto& match : tournament.getMatches()) {
+            fixtures.push_back({indexOf(match->getTeam1()), indexOf(match->getTeam2())});
+        }
+        
+        vector<int> points;
+        teamNames.clear();
+        for (const auto& team : teams) {
+            points.push_back(team->getPoints());
+            teamNames.push_back(team->getName());
+        }
+        base = Standings(points);
+        played = tournament.getCurrentRound();
+        scenarios.clear();
+    }
+    
+    // False if the scenario forces a played fixture or a team not in it
+    bool addScenario(const Scenario& scenario) {
+        for (const auto& f : scenario.forced) {
+            if (f.fixture < played || f.fixture >= (int)fixtures.size()) return false;
+            const Fixture& fixture = fixtures[f.fixture];
+            if (f.winner != -1 && f.winner != fixture.team1 && f.winner != fixture.team2) return false;
+        }
+        scenarios.push_back(scenario);
+        return true;
+    }
+    
+    // End of the shared prefix: the first fixture any scenario forces
+    int prefixEnd() const {
+        int end = (int)fixtures.size();
+        for (const auto& scenario : scenarios) {
+            for (const auto& f : scenario.forced) end = min(end, f.fixture);
+        }
+        return end;
+    }
+    
+    Result run(uint64_t runs, uint64_t seed) const {
+        PhaseTimer timer(Counter::MONTE_CARLO_NS);
+        TraceSpan span("scenarioSweep");
+        Result result;
+        result.runs = runs;
+        result.champions.assign(scenarios.size(), vector<uint64_t>(base.size()));
+        int split = prefixEnd();
+        ForkRandom random{seed};
+        
+        for (uint64_t r = 0; r < runs; r++) {
+            Standings prefix = base;
+            playFixtures(prefix, played, split, nullptr, random, result.simulated);
+            
+            for (size_t s = 0; s < scenarios.size(); s++) {
+                Standings branch = prefix;
+                playFixtures(branch, split, (int)fixtures.size(), &scenarios[s], random, result.simulated);
+                result.champions[s][branch.leader()]++;
+            }
+        }
+        return result;
+    }
+    
+    // Reference sweep: every scenario replays the whole remaining season
+    Result runNaive(uint64_t runs, uint64_t seed) const {
+        PhaseTimer timer(Counter::MONTE_CARLO_NS);
+        TraceSpan span("scenarioSweepNaive");
+        Result result;
+        result.runs = runs;
+        result.champions.assign(scenarios.size(), vector<uint64_t>(base.size()));
+        ForkRandom random{seed};
+        
+        for (uint64_t r = 0; r < runs; r++) {
+            for (size_t s = 0; s < scenarios.size(); s++) {
+                Standings season = base;
+                playFixtures(season, played, (int)fixtures.size(), &scenarios[s], random, result.simulated);
+                result.champions[s][season.leader()]++;
+            }
+        }
+        return result;
+    }
+    
+    int getPlayed() const { return played; }
+    size_t getFixtureCount() const { return fixtures.size(); }
+    const vector<string>& getTeamNames() const { return teamNames; }
+    const vector<Scenario>& getScenarios() const { return scenarios; }
+    
+    string describeFixture(int i) const {
+        return teamNames[fixtures[i].team1] + " vs " + teamNames[fixtures[i].team2];
+    }
+};
+
+/*
+Title and qualification odds for a league fed ball by ball. When the feed
+starts every fixture is sampled once per Monte Carlo run. A delivery then
+re-simulates only the live match from its MatchState, combined with the
+cached points of the sampled remaining fixtures. When a match ends, its
+sampled result is subtracted from those cached totals. Each update costs
+O(runs x remaining live balls), independent of how many fixtures remain.
+*/
+class LiveOdds {
+private:
+    static const int QUALIFIERS = 4;
+    
+    struct Fixture {
+        int team1;
+        int team2;
+    };
+    
+    int teamCount;
+    vector<Fixture> fixtures;
+    size_t live;                    // index of the live fixture
+    MatchState state;
+    vector<int> points;             // completed fixtures
+    
+    uint64_t runs;
+    vector<int8_t> sampled;         // [run * fixtures + f] -> winner, -1 for a tie
+    vector<int> suffixPoints;       // [run * teams + t] from fixtures after the live one
+    ForkRandom random;
+    
+    vector<uint64_t> titles;        // last update: runs won / qualified per team
+    vector<uint64_t> qualified;
+    
+    static void award(int* table, const Fixture& f, int winner, int sign) {
+        if (winner < 0) {
+            table[f.team1] += sign;
+            table[f.team2] += sign;
+        } else {
+            table[winner] += 2 * sign;
+        }
+    }
+    
+    int winnerOf(const Fixture& f, const MatchState& m) const {
+        if (m.innings[0].runs > m.innings[1].runs) return f.team1;
+        if (m.innings[1].runs > m.innings[0].runs) return f.team2;
+        return -1;
+    }
+    
+    // Suffix totals no longer include the fixture that just went live
+    void goLive(size_t f) {
+        live = f;
+        state.innings[0] = InningsState::opening(5, 5);
+        state.innings[1] = InningsState::opening(5, 5);
+        if (live >= fixtures.size()) return;
+        for (uint64_t r = 0; r < runs; r++) {
+            award(&suffixPoints[r * teamCount], fixtures[live], sampled[r * fixtures.size() + live], -1);
+        }
+    }
+    
+public:
+    // Round-robin fixtures (circle method, home and away alternating per
+    // cycle) truncated to matchCount
+    LiveOdds(int teams, int matchCount, uint64_t runCount, uint64_t seed) :
+        teamCount(teams), live(0), points(teams), runs(runCount), random{seed},
+        titles(teams), qualified(teams) {
+        PhaseTimer timer(Counter::MONTE_CARLO_NS);
+        TraceSpan span("liveOddsSetup");
+        
+        int slots = teams + (teams % 2);
+        for (int cycle = 0; (int)fixtures.size() < matchCount; cycle++) {
+            for (int round = 0; round < slots - 1 && (int)fixtures.size() < matchCount; round++) {
+                for (int i = 0; i < slots / 2 && (int)fixtures.size() < matchCount; i++) {
+                    int a = i == 0 ? 0 : 1 + (round + i - 1) % (slots - 1);
+                    int b = 1 + (round + slots - 2 - i) % (slots - 1);
+                    if (a >= teams || b >= teams) continue;  // bye
+                    fixtures.push_back(cycle % 2 ? Fixture{b, a} : Fixture{a, b});
+                }
+            }
+        }
+        
+        sampled.resize(runs * fixtures.size());
+        suffixPoints.assign(runs * teamCount, 0);
+        for (uint64_t r = 0; r < runs; r++) {
+            for (size_t f = 0; f < fixtures.size(); f++) {
+                MatchState m;
+                m.innings[0] = InningsState::opening(5, 5);
+                m.innings[1] = InningsState::opening(5, 5);
+                WhatIf::playOut(m, random);
+                int winner = winnerOf(fixtures[f], m);
+                sampled[r * fixtures.size() + f] = (int8_t)winner;
+                award(&suffixPoints[r * teamCount], fixtures[f], winner, 1);
+            }
+        }
+        goLive(0);
+    }
+    
+    // Apply one delivery (raw outcome, 5 = wicket); true when it ends the match
+    bool ball(int outcome) {
+        if (isSeasonOver()) return false;
+        InningsState& innings = state.innings[0].isComplete() ? state.innings[1] : state.innings[0];
+        innings.advance(outcome);
+        if (!state.isComplete()) return false;
+        
+        award(points.data(), fixtures[live], winnerOf(fixtures[live], state), 1);
+        goLive(live + 1);
+        return true;
+    }
+    
+    // Re-simulate the live match once per run and rank the final tables
+    void update() {
+        PhaseTimer timer(Counter::MONTE_CARLO_NS);
+        TraceSpan span("liveOddsUpdate");
+        fill(titles.begin(), titles.end(), 0);
+        fill(qualified.begin(), qualified.end(), 0);
+        vector<int> table(teamCount);
+        
+        for (uint64_t r = 0; r < runs; r++) {
+            const int* suffix = &suffixPoints[r * teamCount];
+            for (int t = 0; t < teamCount; t++) table[t] = points[t] + suffix[t];
+            if (!isSeasonOver()) {
+                MatchState m = state;
+                WhatIf::playOut(m, random);
+                award(table.data(), fixtures[live], winnerOf(fixtures[live], m), 1);
+            }
+            
+            // Position: teams ahead on points, earlier team on a tie
+            for (int t = 0; t < teamCount; t++) {
+                int position = 0;
+                for (int u = 0; u < teamCount; u++) {
+                    if (table[u] > table[t] || (table[u] == table[t] && u < t)) position++;
+                }
+                if (position == 0) titles[t]++;
+                if (position < QUALIFIERS) qualified[t]++;
+            }
+        }
+    }
+    
+    bool isSeasonOver() const { return live >= fixtures.size(); }
+    size_t getLive() const { return live; }
+    size_t getFixtureCount() const { return fixtures.size(); }
+    int getTeamCount() const { return teamCount; }
+    const Fixture& getFixture(size_t f) const { return fixtures[f]; }
+    const MatchState& getState() const { return state; }
+    int getPoints(int team) const { return points[team]; }
+    double titleOdds(int team) const { return 100.0 * titles[team] / runs; }
+    double qualifyOdds(int team) const { return 100.0 * qualified[team] / runs; }
+};
+
+// Career totals of one player across tournaments (64 bytes on disk)
+struct CareerRecord {
+    uint64_t key;          // FNV-1a hash of the player name, moved on past other names' records
+    char name[24];
+    int32_t runs;
+    int32_t ballsFaced;
+    int32_t wickets;
+    int32_t ballsBowled;
+    int32_t runsConceded;
+    int32_t credits;
+    int32_t tournaments;
+    uint32_t checksum;     // CRC-32C of the bytes above (log entries only)
+};
+static_assert(sizeof(CareerRecord) == 64, "CareerRecord must stay 64 bytes");
+
+struct CareerFileHeader {
+    char magic[8];         // "IPLCSNP1" (snapshot) or "IPLCLOG2" (log)
+    uint64_t generation;   // a log only applies to the snapshot of the same generation
+    uint64_t count;        // snapshot record count (0 for the log)
+    uint32_t checksum;     // CRC-32C of the snapshot records
+    uint32_t reserved;
+};
+
+// Frames one tournament's deltas in the career log
+struct CareerBatchHeader {
+    uint32_t magic;        // 'CBT0'
+    uint32_t recordCount;
+    uint32_t checksum;     // CRC-32C of the batch's records
+    uint32_t reserved;
+};
+
+/*
+Persistent career store in a directory:
+  careers.snap  compacted snapshot, records sorted by key, memory-mapped on open
+  careers.log   append-only log, one checksummed batch of deltas per tournament
+Each batch is fsync'd before it is applied in memory; a torn tail batch fails
+its checksum and is dropped whole, so a tournament is never half recorded.
+Compaction writes a new snapshot under a temporary name and renames it over the
+old one, bumping the generation so a log that was already folded in is discarded.
+*/
+class CareerStore {
+private:
+    static const size_t COMPACT_THRESHOLD = 1 << 12;  // log records
+    static const uint32_t BATCH_MAGIC = 0x30544243;     // "CBT0"
+
+    string directory;
+    MappedFile snapshotFile;
+    const CareerRecord* snapshot;
+    uint64_t snapshotCount;
+    uint64_t generation;
+    unordered_map<uint64_t, CareerRecord> overlay;  // snapshot totals plus logged deltas
+    FILE* log;
+    size_t logRecords;
+
+    string snapshotPath() const { return directory + "/careers.snap"; }
+    string logPath() const { return directory + "/careers.log"; }
+
+    static uint32_t recordChecksum(const CareerRecord& r) {
+        return Crc32c::compute(&r, offsetof(CareerRecord, checksum));
+    }
+
+    const CareerRecord* findInSnapshot(uint64_t key) const {
+        const CareerRecord* end = snapshot + snapshotCount;
+        const CareerRecord* it = lower_bound(snapshot, end, key,
+            [](const CareerRecord& r, uint64_t k) { return r.key < k; });
+        return it != end && it->key == key ? it : nullptr;
+    }
+
+    const CareerRecord* find(uint64_t key) const {
+        auto it = overlay.find(key);
+        return it != overlay.end() ? &it->second : findInSnapshot(key);
+    }
+
+    // Stored names are truncated, so compare the same prefix
+    static bool holdsName(const CareerRecord& r, string_view name) {
+        return string_view(r.name, strnlen(r.name, sizeof(r.name))) == name.substr(0, sizeof(r.name) - 1);
+    }
+
+    // Names whose hashes collide must not share a career: a name's key is its
+    // hash, or the first key after it not taken by a record of another name,
+    // stored or among the unwritten deltas of batch. Keys are stored with the
+    // records, so a name keeps its key across runs.
+    uint64_t resolveKey(string_view name, bool& found, const vector<CareerRecord>& batch = {}) const {
+        for (uint64_t key = keyFor(name);; key++) {
+            const CareerRecord* r = find(key);
+            for (size_t i = 0; !r && i < batch.size(); i++) {
+                if (batch[i].key == key) r = &batch[i];
+            }
+            if (!r || holdsName(*r, name)) {
+                found = r != nullptr;
+                return key;
+            }
+        }
+    }
+
+    static bool write(FILE* out, const void* data, size_t size, size_t count) {
+        return count == 0 || fwrite(data, size, count, out) == count;
+    }
+
+    void applyDelta(const CareerRecord& delta) {
+        auto it = overlay.find(delta.key);
+        if (it == overlay.end()) {
+            const CareerRecord* base = findInSnapshot(delta.key);
+            CareerRecord start = {};
+            if (base) {
+                start = *base;
+            } else {
+                start.key = delta.key;
+                memcpy(start.name, delta.name, sizeof(start.name));
+            }
+            it = overlay.emplace(delta.key, start).first;
+        }
+        CareerRecord& r = it->second;
+        r.runs += delta.runs;
+        r.ballsFaced += delta.ballsFaced;
+        r.wickets += delta.wickets;
+        r.ballsBowled += delta.ballsBowled;
+        r.runsConceded += delta.runsConceded;
+        r.credits += delta.credits;
+        r.tournaments += delta.tournaments;
+    }
+
+    bool loadSnapshot() {
+        snapshot = nullptr;
+        snapshotCount = 0;
+        generation = 0;
+        if (!snapshotFile.open(snapshotPath())) return true;  // no snapshot yet
+
+        const CareerFileHeader* header = (const CareerFileHeader*)snapshotFile.data();
+        if (snapshotFile.size() < sizeof(CareerFileHeader) || memcmp(header->magic, "IPLCSNP1", 8) != 0 ||
+            snapshotFile.size() != sizeof(CareerFileHeader) + header->count * sizeof(CareerRecord)) {
+            return false;
+        }
+        snapshot = (const CareerRecord*)(header + 1);
+        snapshotCount = header->count;
+        generation = header->generation;
+        return true;
+    }
+
+    // Replay the complete batches of a log of the current generation; returns
+    // their length in bytes and whether the file holds nothing else (no torn
+    // batch, no stale generation). logRecords counts the replayed deltas.
+    size_t replayLog(bool& clean) {
+        clean = false;
+        logRecords = 0;
+        FILE* in = fopen(logPath().c_str(), "rb");
+        if (!in) return 0;
+        fseek(in, 0, SEEK_END);
+        uint64_t fileSize = (uint64_t)ftell(in);
+        fseek(in, 0, SEEK_SET);
+
+        CareerFileHeader header;
+        size_t intact = 0;
+        if (fread(&header, sizeof(header), 1, in) == 1 && memcmp(header.magic, "IPLCLOG2", 8) == 0 &&
+            header.generation == generation) {
+            CareerBatchHeader batch;
+            vector<CareerRecord> records;
+            while (fread(&batch, sizeof(batch), 1, in) == 1 && batch.magic == BATCH_MAGIC) {
+                uint64_t left = fileSize - (sizeof(header) + intact + sizeof(batch));
+                if (batch.recordCount > left / sizeof(CareerRecord)) break;
+                records.resize(batch.recordCount);
+                if (fread(records.data(), sizeof(CareerRecord), records.size(), in) != records.size() ||
+                    batch.checksum != Crc32c::compute(records.data(), records.size() * sizeof(CareerRecord))) {
+                    break;
+                }
+                for (const CareerRecord& r : records) applyDelta(r);
+                intact += sizeof(batch) + records.size() * sizeof(CareerRecord);
+                logRecords += records.size();
+            }
+            clean = fileSize == sizeof(header) + intact;
+        }
+        fclose(in);
+        return intact;
+    }
+
+    // Rewrite the log with only the batches that replayed cleanly
+    bool startLog(size_t keepBytes) {
+        string tmp = logPath() + ".tmp";
+        FILE* out = fopen(tmp.c_str(), "wb");
+        if (!out) return false;
+
+        CareerFileHeader header = {};
+        memcpy(header.magic, "IPLCLOG2", 8);
+        header.generation = generation;
+        bool ok = write(out, &header, sizeof(header), 1);
+
+        if (ok && keepBytes > 0) {
+            FILE* in = fopen(logPath().c_str(), "rb");
+            ok = in != nullptr;
+            if (in) {
+                fseek(in, sizeof(CareerFileHeader), SEEK_SET);
+                vector<char> chunk(1 << 16);
+                while (ok && keepBytes > 0) {
+                    size_t n = min(keepBytes, chunk.size());
+                    ok = fread(chunk.data(), 1, n, in) == n && write(out, chunk.data(), 1, n);
+                    keepBytes -= n;
+                }
+                fclose(in);
+            }
+        }
+
+        ok = ok && FileSync::sync(out);
+        if (fclose(out) != 0) ok = false;
+        if (!ok || !FileSync::replace(tmp, logPath())) return false;
+
+        log = fopen(logPath().c_str(), "ab");
+        return log != nullptr;
+    }
+
+public:
+    CareerStore() : snapshot(nullptr), snapshotCount(0), generation(0), log(nullptr), logRecords(0) {}
+
+    ~CareerStore() { close(); }
+
+    CareerStore(const CareerStore&) = delete;
+    CareerStore& operator=(const CareerStore&) = delete;
+
+    static uint64_t keyFor(string_view name) {
+        uint64_t h = 1469598103934665603ull;
+        for (char c : name) {
+            h ^= (uint8_t)c;
+            h *= 1099511628211ull;
+        }
+        return h;
+    }
+
+    bool open(const string& dir) {
+        directory = dir;
+        overlay.clear();
+        if (!loadSnapshot()) return false;
+
+        bool clean;
+        size_t intact = replayLog(clean);
+        if (!clean) return startLog(intact);
+
+        log = fopen(logPath().c_str(), "ab");
+        return log != nullptr;
+    }
+
+    void close() {
+        if (log) fclose(log);
+        log = nullptr;
+        snapshotFile.close();
+        snapshot = nullptr;
+        snapshotCount = 0;
+    }
+
+    // Append one batch of per-player deltas for a finished tournament, make it
+    // durable, then apply it. After a failed write the store takes no more
+    // batches: a later batch behind a torn one would be dropped on replay.
+    bool recordTournament(const vector<shared_ptr<Player>>& players) {
+        if (!log) return false;
+        vector<CareerRecord> deltas;
+        deltas.reserve(players.size());
+        for (const auto& p : players) {
+            CareerRecord delta = {};
+            string_view name = p->getName();
+            bool found;
+            delta.key = resolveKey(name, found, deltas);
+            memcpy(delta.name, name.data(), min(name.size(), sizeof(delta.name) - 1));
+            delta.runs = p->getTotalRunsScored();
+            delta.ballsFaced = p->getTotalBallsFaced();
+            delta.wickets = p->getTotalWicketsTaken();
+            delta.ballsBowled = p->getTotalBallsBowled();
+            delta.runsConceded = p->getTotalRunsConceded();
+            delta.credits = p->getTotalCredits();
+            delta.tournaments = 1;
+            delta.checksum = recordChecksum(delta);
+            deltas.push_back(delta);
+        }
+
+        CareerBatchHeader batch = {};
+        batch.magic = BATCH_MAGIC;
+        batch.recordCount = (uint32_t)deltas.size();
+        batch.checksum = Crc32c::compute(deltas.data(), deltas.size() * sizeof(CareerRecord));
+        if (!write(log, &batch, sizeof(batch), 1) || !write(log, deltas.data(), sizeof(CareerRecord), deltas.size()) ||
+            !FileSync::sync(log)) {
+            fclose(log);
+            log = nullptr;
+            return false;
+        }
+        for (const CareerRecord& delta : deltas) applyDelta(delta);
+        logRecords += deltas.size();
+        return logRecords < COMPACT_THRESHOLD || compact();
+    }
+
+    bool lookup(string_view name, CareerRecord& out) const {
+        bool found;
+        const CareerRecord* r = find(resolveKey(name, found));
+        if (found) out = *r;
+        return found;
+    }
+
+    // Merge snapshot and overlay into a new snapshot of the next generation
+    bool compact() {
+        vector<CareerRecord> merged;
+        merged.reserve(snapshotCount + overlay.size());
+        for (uint64_t i = 0; i < snapshotCount; i++) {
+            if (!overlay.count(snapshot[i].key)) merged.push_back(snapshot[i]);
+        }
+        for (const auto& entry : overlay) {
+            CareerRecord r = entry.second;
+            r.checksum = 0;
+            merged.push_back(r);
+        }
+        sort(merged.begin(), merged.end(), [](const CareerRecord& a, const CareerRecord& b) { return a.key < b.key; });
+
+        CareerFileHeader header = {};
+        memcpy(header.magic, "IPLCSNP1", 8);
+        header.generation = generation + 1;
+        header.count = merged.size();
+        header.checksum = Crc32c::compute(merged.data(), merged.size() * sizeof(CareerRecord));
+
+        string tmp = snapshotPath() + ".tmp";
+        FILE* out = fopen(tmp.c_str(), "wb");
+        if (!out) return false;
+        bool ok = write(out, &header, sizeof(header), 1) &&
+                  write(out, merged.data(), sizeof(CareerRecord), merged.size()) && FileSync::sync(out);
+        if (fclose(out) != 0) ok = false;
+        if (!ok) return false;
+
+        // The old snapshot is unmapped first (Windows cannot replace a mapped
+        // file); if the rename fails it is still in place, so map it again and
+        // keep appending to the current log
+        close();
+        if (!FileSync::replace(tmp, snapshotPath())) {
+            if (loadSnapshot()) log = fopen(logPath().c_str(), "ab");
+            return false;
+        }
+        overlay.clear();
+        logRecords = 0;
+        return loadSnapshot() && startLog(0);
+    }
+
+    // Full checksum pass over the snapshot; open() only checks its framing so
+    // startup does not touch every page (snapshots are fsync'd before the rename)
+    bool verifySnapshot() const {
+        if (!snapshot) return true;
+        const CareerFileHeader* header = (const CareerFileHeader*)snapshotFile.data();
+        return header->checksum == Crc32c::compute(snapshot, snapshotCount * sizeof(CareerRecord));
+    }
+
+    size_t size() const {
+        size_t fresh = 0;
+        for (const auto& entry : overlay) fresh += findInSnapshot(entry.first) == nullptr;
+        return (size_t)snapshotCount + fresh;
+    }
+};
+
+// Fixed-capacity byte buffer drained to a FILE* in large writes
+class OutputBuffer {
+private:
+    FILE* file;
+    vector<char> buffer;
+    size_t used;
+    bool failed;  // sticky: a short write loses data for good
+
+    void write(const char* data, size_t len) {
+        if (file && fwrite(data, 1, len, file) != len) failed = true;
+    }
+
+public:
+    explicit OutputBuffer(size_t capacity = 1 << 20) : file(nullptr), buffer(capacity), used(0), failed(false) {}
+
+    ~OutputBuffer() { flush(); }
+
+    OutputBuffer(const OutputBuffer&) = delete;
+    OutputBuffer& operator=(const OutputBuffer&) = delete;
+
+    void attach(FILE* f) {
+        file = f;
+        failed = false;
+    }
+
+    void flush() {
+        if (used > 0) write(buffer.data(), used);
+        used = 0;
+    }
+
+    bool ok() const { return !failed; }
+
+    void append(const char* data, size_t len) {
+        if (used + len > buffer.size()) {
+            flush();
+            if (len > buffer.size()) {
+                write(data, len);
+                return;
+            }
+        }
+        memcpy(buffer.data() + used, data, len);
+        used += len;
+    }
+
+    void append(string_view text) { append(text.data(), text.size()); }
+
+    void append(char c) {
+        if (used == buffer.size()) flush();
+        buffer[used++] = c;
+    }
+
+    void appendUInt(uint64_t value) {
+        char digits[20];
+        int pos = 20;
+        do {
+            digits[--pos] = (char)('0' + value % 10);
+            value /= 10;
+        } while (value > 0);
+        append(digits + pos, 20 - pos);
+    }
+
+    void appendInt(int64_t value) {
+        if (value < 0) {
+            append('-');
+            appendUInt(0 - (uint64_t)value);
+        } else {
+            appendUInt((uint64_t)value);
+        }
+    }
+
+    // Fixed-point formatting with two decimals (no locale, no iostream)
+    void appendFixed2(double value) {
+        if (value < 0) {
+            append('-');
+            value = -value;
+        }
+        uint64_t scaled = (uint64_t)(value * 100 + 0.5);
+        appendUInt(scaled / 100);
+        append('.');
+        append((char)('0' + scaled / 10 % 10));
+        append((char)('0' + scaled % 10));
+    }
+};
+
+// Column types shared by the CSV and columnar writers
+enum class ColumnType : uint8_t {
+    UINT8,
+    UINT32,
+    INT32,
+    FLOAT64,
+    UTF8
+};
+
+struct ColumnSpec {
+    const char* name;
+    ColumnType type;
+};
+
+// CSV table writer; values are formatted straight into the output buffer
+class CsvWriter {
+private:
+    FILE* file;
+    OutputBuffer out;
+    size_t columns;
+    size_t column;
+
+    void separator() {
+        if (column++ > 0) out.append(',');
+    }
+
+public:
+    CsvWriter() : file(nullptr), columns(0), column(0) {}
+
+    ~CsvWriter() { close(); }
+
+    bool open(const string& path, const vector<ColumnSpec>& schema) {
+        file = fopen(path.c_str(), "wb");
+        if (!file) return false;
+        out.attach(file);
+        columns = schema.size();
+        for (const auto& spec : schema) {
+            separator();
+            out.append(spec.name, strlen(spec.name));
+        }
+        endRow();
+        return true;
+    }
+
+    void u8(uint8_t v) { separator(); out.appendUInt(v); }
+    void u32(uint32_t v) { separator(); out.appendUInt(v); }
+    void i32(int32_t v) { separator(); out.appendInt(v); }
+    void f64(double v) { separator(); out.appendFixed2(v); }
+
+    void str(string_view v) {
+        separator();
+        if (v.find_first_of(",\"\n") == string_view::npos) {
+            out.append(v);
+            return;
+        }
+        out.append('"');
+        for (char c : v) {
+            if (c == '"') out.append('"');
+            out.append(c);
+        }
+        out.append('"');
+    }
+
+    void endRow() {
+        out.append('\n');
+        column = 0;
+    }
+
+    // False if any write failed
+    bool close() {
+        if (!file) return false;
+        out.flush();
+        bool ok = out.ok() && !ferror(file);
+        if (fclose(file) != 0) ok = false;
+        file = nullptr;
+        return ok;
+    }
+};
+
+/*
+Columnar file layout (little-endian; every section starts on a 64-byte boundary
+and every buffer is zero-padded to a multiple of 64 bytes, as in Arrow):
+  [ColumnarFileHeader][ColumnarColumnDesc x columnCount]
+  per batch: [ColumnarBatchHeader] then for each column its buffers:
+      fixed-width columns: values (rows x width)
+      UTF8 columns:        int32 offsets (rows + 1), then the character data
+  [ColumnarTrailer]
+Buffers follow Arrow's physical layout for non-null columns, so a reader can wrap
+them without copying; the Arrow IPC flatbuffer framing itself is not written.
+*/
+struct ColumnarFileHeader {
+    char magic[8];        // "IPLCOL01"
+    uint32_t columnCount;
+    uint32_t batchRows;
+};
+
+struct ColumnarColumnDesc {
+    char name[23];
+    uint8_t type;         // ColumnType
+};
+
+struct ColumnarBatchHeader {
+    uint32_t magic;       // 'BAT0'
+    uint32_t rows;
+    uint64_t bodyBytes;
+};
+
+struct ColumnarTrailer {
+    uint64_t batchCount;
+    uint64_t rowCount;
+    char magic[8];        // "IPLCOLND"
+};
+
+// Chunked columnar writer; column buffers are reused between batches
+class ColumnarWriter {
+public:
+    static const uint32_t BATCH_MAGIC = 0x30544142;  // "BAT0"
+
+private:
+    struct Column {
+        ColumnType type;
+        vector<uint8_t> values;
+        vector<int32_t> offsets;
+    };
+
+    FILE* file;
+    vector<Column> columns;
+    size_t column;
+    uint32_t rows;
+    uint32_t batchRows;
+    uint64_t batchCount;
+    uint64_t rowCount;
+    bool failed;  // sticky; reported by close()
+
+    static size_t padded(size_t bytes) { return (bytes + 63) & ~(size_t)63; }
+
+    void write(const void* data, size_t bytes) {
+        if (bytes && fwrite(data, 1, bytes, file) != bytes) failed = true;
+    }
+
+    template <typename T>
+    void put(T value) {
+        Column& c = columns[column++];
+        size_t at = c.values.size();
+        c.values.resize(at + sizeof(T));
+        memcpy(c.values.data() + at, &value, sizeof(T));
+    }
+
+    void writePadded(const void* data, size_t bytes) {
+        static const uint8_t zeros[64] = {};
+        write(data, bytes);
+        write(zeros, padded(bytes) - bytes);
+    }
+
+    void flushBatch() {
+        if (rows == 0) return;
+
+        ColumnarBatchHeader header;
+        header.magic = BATCH_MAGIC;
+        header.rows = rows;
+        header.bodyBytes = 0;
+        for (const auto& c : columns) {
+            if (c.type == ColumnType::UTF8) header.bodyBytes += padded(c.offsets.size() * sizeof(int32_t));
+            header.bodyBytes += padded(c.values.size());
+        }
+        writePadded(&header, sizeof(header));
+
+        for (auto& c : columns) {
+            if (c.type == ColumnType::UTF8) {
+                writePadded(c.offsets.data(), c.offsets.size() * sizeof(int32_t));
+                c.offsets.assign(1, 0);
+            }
+            writePadded(c.values.data(), c.values.size());
+            c.values.clear();
+        }
+
+        batchCount++;
+        rows = 0;
+    }
+
+public:
+    explicit ColumnarWriter(uint32_t rowsPerBatch = 1 << 16) : file(nullptr), column(0), rows(0),
+        batchRows(rowsPerBatch), batchCount(0), rowCount(0), failed(false) {}
+
+    ~ColumnarWriter() { close(); }
+
+    bool open(const string& path, const vector<ColumnSpec>& schema) {
+        file = fopen(path.c_str(), "wb");
+        if (!file) return false;
+
+        ColumnarFileHeader header;
+        memcpy(header.magic, "IPLCOL01", 8);
+        header.columnCount = (uint32_t)schema.size();
+        header.batchRows = batchRows;
+        failed = false;
+        write(&header, sizeof(header));
+
+        columns.clear();
+        for (const auto& spec : schema) {
+            ColumnarColumnDesc desc = {};
+            strncpy(desc.name, spec.name, sizeof(desc.name) - 1);
+            desc.type = (uint8_t)spec.type;
+            write(&desc, sizeof(desc));
+
+            Column c;
+            c.type = spec.type;
+            if (spec.type == ColumnType::UTF8) c.offsets.assign(1, 0);
+            columns.push_back(move(c));
+        }
+
+        static const uint8_t zeros[64] = {};
+        size_t headerBytes = sizeof(header) + schema.size() * sizeof(ColumnarColumnDesc);
+        write(zeros, padded(headerBytes) - headerBytes);
+        return !failed;
+    }
+
+    void u8(uint8_t v) { put(v); }
+    void u32(uint32_t v) { put(v); }
+    void i32(int32_t v) { put(v); }
+    void f64(double v) { put(v); }
+
+    void str(string_view v) {
+        Column& c = columns[column++];
+        c.values.insert(c.values.end(), v.begin(), v.end());
+        c.offsets.push_back((int32_t)c.values.size());
+    }
+
+    void endRow() {
+        column = 0;
+        rows++;
+        rowCount++;
+        if (rows == batchRows) flushBatch();
+    }
+
+    // False if any write failed
+    bool close() {
+        if (!file) return false;
+        flushBatch();
+
+        ColumnarTrailer trailer;
+        trailer.batchCount = batchCount;
+        trailer.rowCount = rowCount;
+        memcpy(trailer.magic, "IPLCOLND", 8);
+        write(&trailer, sizeof(trailer));
+
+        if (ferror(file)) failed = true;
+        if (fclose(file) != 0) failed = true;
+        file = nullptr;
+        return !failed;
+    }
+};
+
+// Player, team, match and ball tables; each emit function drives either writer
+class StatsExporter {
+public:
+    static const vector<ColumnSpec>& playerSchema() {
+        static const vector<ColumnSpec> schema = {
+            {"player_id", ColumnType::UINT32}, {"name", ColumnType::UTF8}, {"type", ColumnType::UINT8},
+            {"runs", ColumnType::INT32}, {"balls_faced", ColumnType::INT32}, {"wickets", ColumnType::INT32},
+            {"balls_bowled", ColumnType::INT32}, {"runs_conceded", ColumnType::INT32}, {"credits", ColumnType::INT32}};
+        return schema;
+    }
+
+    static const vector<ColumnSpec>& teamSchema() {
+        static const vector<ColumnSpec> schema = {
+            {"name", ColumnType::UTF8}, {"city", ColumnType::UTF8}, {"played", ColumnType::INT32},
+            {"won", ColumnType::INT32}, {"lost", ColumnType::INT32}, {"tied", ColumnType::INT32},
+            {"points", ColumnType::INT32}, {"win_pct", ColumnType::FLOAT64}};
+        return schema;
+    }
+
+    static const vector<ColumnSpec>& matchSchema() {
+        static const vector<ColumnSpec> schema = {
+            {"match_id", ColumnType::UINT32}, {"team1", ColumnType::UTF8}, {"team2", ColumnType::UTF8},
+            {"team1_runs", ColumnType::INT32}, {"team1_wickets", ColumnType::INT32},
+            {"team2_runs", ColumnType::INT32}, {"team2_wickets", ColumnType::INT32},
+            {"result", ColumnType::UINT8}, {"player_of_match", ColumnType::UTF8}};
+        return schema;
+    }
+
+    static const vector<ColumnSpec>& ballSchema() {
+        static const vector<ColumnSpec> schema = {
+            {"match_id", ColumnType::UINT32}, {"innings", ColumnType::UINT8}, {"ball", ColumnType::UINT8},
+            {"over", ColumnType::UINT8}, {"striker_id", ColumnType::UINT32}, {"bowler_id", ColumnType::UINT32},
+            {"outcome", ColumnType::UINT8}, {"runs", ColumnType::UINT8}};
+        return schema;
+    }
+
+    template <typename Writer>
+    static void emitPlayers(const vector<shared_ptr<Player>>& players, Writer& w) {
+        for (const auto& p : players) {
+            w.u32(p->getId());
+            w.str(p->getName());
+            w.u8((uint8_t)p->getType());
+            w.i32(p->getTotalRunsScored());
+            w.i32(p->getTotalBallsFaced());
+            w.i32(p->getTotalWicketsTaken());
+            w.i32(p->getTotalBallsBowled());
+            w.i32(p->getTotalRunsConceded());
+            w.i32(p->getTotalCredits());
+            w.endRow();
+        }
+    }
+
+    template <typename Writer>
+    static void emitTeams(const vector<shared_ptr<Team>>& teams, Writer& w) {
+        for (const auto& t : teams) {
+            w.str(t->getName());
+            w.str(t->getCity());
+            w.i32(t->getMatchesPlayed());
+            w.i32(t->getMatchesWon());
+            w.i32(t->getMatchesLost());
+            w.i32(t->getMatchesTied());
+            w.i32(t->getPoints());
+            w.f64(t->getWinPercentage());
+            w.endRow();
+        }
+    }
+
+    template <typename Writer>
+    static void emitMatches(const vector<Match*>& matches, Writer& w) {
+        for (const auto& m : matches) {
+            if (!m->getPlayerOfMatch()) continue;  // not played yet
+            w.u32(m->getMatchId());
+            w.str(m->getTeam1()->getName());
+            w.str(m->getTeam2()->getName());
+            w.i32(m->getFirstInnings().getTotalRuns());
+            w.i32(m->getFirstInnings().getTotalWickets());
+            w.i32(m->getSecondInnings().getTotalRuns());
+            w.i32(m->getSecondInnings().getTotalWickets());
+            w.u8((uint8_t)m->getResult());
+            w.str(m->getPlayerOfMatch()->getName());
+            w.endRow();
+        }
+    }
+
+    template <typename Writer>
+    static void emitBalls(const MappedBallLog& log, Writer& w) {
+        log.forEachEvent([&](const BallEvent& e) {
+            w.u32(e.matchId);
+            w.u8(e.innings);
+            w.u8(e.ballIndex);
+            w.u8((uint8_t)(e.ballIndex / 6));
+            w.u32(e.strikerId);
+            w.u32(e.bowlerId);
+            w.u8(e.outcome);
+            w.u8((uint8_t)runsFor((BallOutcome)e.outcome));
+            w.endRow();
+        });
+    }
+
+    // Write <dir>/<table>.csv and <dir>/<table>.col
+    template <typename Emit>
+    static bool writeTable(const string& dir, const string& table, const vector<ColumnSpec>& schema, Emit&& emit) {
+        CsvWriter csv;
+        ColumnarWriter columnar;
+        if (!csv.open(dir + "/" + table + ".csv", schema)) return false;
+        if (!columnar.open(dir + "/" + table + ".col", schema)) return false;
+        emit(csv);
+        emit(columnar);
+        bool csvWritten = csv.close();
+        bool columnarWritten = columnar.close();
+        return csvWritten && columnarWritten;
+    }
+
+    static bool exportTournament(const Tournament& tournament, const string& dir);
+
+    static bool exportBalls(const MappedBallLog& log, const string& dir) {
+        return writeTable(dir, "balls", ballSchema(), [&](auto& w) { emitBalls(log, w); });
+    }
+};
+
+bool StatsExporter::exportTournament(const Tournament& tournament, const string& dir) {
+    PhaseTimer timer(Counter::EXPORT_NS);
+    TraceSpan span("exportTournament");
+    return writeTable(dir, "players", playerSchema(), [&](auto& w) { emitPlayers(tournament.getPlayers(), w); }) &&
+           writeTable(dir, "teams", teamSchema(), [&](auto& w) { emitTeams(tournament.getTeams(), w); }) &&
+           writeTable(dir, "matches", matchSchema(), [&](auto& w) { emitMatches(tournament.getMatches(), w); });
+}
+
+// Columns of the ball-event table that queries can filter and group on
+enum class BallColumn : uint8_t {
+    INNINGS,
+    OVER,
+    WICKETS_DOWN,
+    OUTCOME,
+    STRIKER_TYPE,
+    BOWLER_TYPE,
+    STRIKER,
+    BOWLER
+};
+
+// Structure-of-arrays copy of a ball log, with derived over/wickets/type columns
+class BallColumns {
+public:
+    vector<uint32_t> matchId;
+    vector<uint32_t> striker;
+    vector<uint32_t> bowler;
+    vector<uint8_t> innings;
+    vector<uint8_t> over;
+    vector<uint8_t> wicketsDown;  // wickets fallen before this ball
+    vector<uint8_t> outcome;
+    vector<uint8_t> runs;
+    vector<uint8_t> strikerType;
+    vector<uint8_t> bowlerType;
+    uint32_t maxPlayerId = 0;
+
+    size_t rows() const { return outcome.size(); }
+
+    static bool isWide(BallColumn column) {
+        return column == BallColumn::STRIKER || column == BallColumn::BOWLER;
+    }
+
+    const uint8_t* bytes(BallColumn column) const {
+        switch (column) {
+            case BallColumn::INNINGS: return innings.data();
+            case BallColumn::OVER: return over.data();
+            case BallColumn::WICKETS_DOWN: return wicketsDown.data();
+            case BallColumn::OUTCOME: return outcome.data();
+            case BallColumn::STRIKER_TYPE: return strikerType.data();
+            case BallColumn::BOWLER_TYPE: return bowlerType.data();
+            default: return nullptr;
+        }
+    }
+
+    const uint32_t* words(BallColumn column) const {
+        return column == BallColumn::STRIKER ? striker.data() : bowler.data();
+    }
+
+    uint32_t value(BallColumn column, size_t row) const {
+        return isWide(column) ? words(column)[row] : bytes(column)[row];
+    }
+
+    // playerTypes maps player id to PlayerType for the type columns
+    static BallColumns fromLog(const MappedBallLog& log, const vector<PlayerType>& playerTypes) {
+        BallColumns c;
+        size_t n = (size_t)log.getEventCount();
+        c.matchId.reserve(n);
+        c.striker.reserve(n);
+        c.bowler.reserve(n);
+        c.innings.reserve(n);
+        c.over.reserve(n);
+        c.wicketsDown.reserve(n);
+        c.outcome.reserve(n);
+        c.runs.reserve(n);
+        c.strikerType.reserve(n);
+        c.bowlerType.reserve(n);
+
+        auto typeOf = [&](uint32_t id) {
+            return (uint8_t)(id < playerTypes.size() ? playerTypes[id] : PlayerType::BATSMAN);
+        };
+
+        uint8_t fallen = 0;
+        log.forEachEvent([&](const BallEvent& e) {
+            if (e.ballIndex == 0) fallen = 0;
+            c.matchId.push_back(e.matchId);
+            c.striker.push_back(e.strikerId);
+            c.bowler.push_back(e.bowlerId);
+            c.innings.push_back(e.innings);
+            c.over.push_back((uint8_t)(e.ballIndex / 6));
+            c.wicketsDown.push_back(fallen);
+            c.outcome.push_back(e.outcome);
+            c.runs.push_back((uint8_t)runsFor((BallOutcome)e.outcome));
+            c.strikerType.push_back(typeOf(e.strikerId));
+            c.bowlerType.push_back(typeOf(e.bowlerId));
+            if ((BallOutcome)e.outcome == BallOutcome::WICKET) fallen++;
+            c.maxPlayerId = max(c.maxPlayerId, max(e.strikerId, e.bowlerId));
+        });
+        return c;
+    }
+};
+
+// Equality filters producing one 64-bit selection word per 64 rows
+class FilterKernels {
+public:
+    static uint64_t eq8(const uint8_t* col, size_t count, uint8_t value) {
+        uint64_t mask = 0;
+        size_t i = 0;
+#if defined(__AVX2__)
+        __m256i needle = _mm256_set1_epi8((char)value);
+        for (; i + 32 <= count; i += 32) {
+            __m256i v = _mm256_loadu_si256((const __m256i*)(col + i));
+            mask |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, needle)) << i;
+        }
+#elif defined(__SSE2__)
+        __m128i needle = _mm_set1_epi8((char)value);
+        for (; i + 16 <= count; i += 16) {
+            __m128i v = _mm_loadu_si128((const __m128i*)(col + i));
+            mask |= (uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, needle)) << i;
+        }
+#endif
+        for (; i < count; i++) mask |= (uint64_t)(col[i] == value) << i;
+        return mask;
+    }
+
+    static uint64_t eq32(const uint32_t* col, size_t count, uint32_t value) {
+        uint64_t mask = 0;
+        size_t i = 0;
+#if defined(__SSE2__)
+        __m128i needle = _mm_set1_epi32((int)value);
+        for (; i + 4 <= count; i += 4) {
+            __m128i v = _mm_loadu_si128((const __m128i*)(col + i));
+            mask |= (uint64_t)(uint32_t)_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(v, needle))) << i;
+        }
+#endif
+        for (; i < count; i++) mask |= (uint64_t)(col[i] == value) << i;
+        return mask;
+    }
+};
+
+// Whole-string decimal parse; false on empty input, trailing junk, a sign
+// on an unsigned type or overflow. Never throws.
+template <typename T>
+bool parseNumber(string_view text, T& value) {
+    const char* end = text.data() + text.size();
+    auto result = from_chars(text.data(), end, value);
+    return !text.empty() && result.ec == errc() && result.ptr == end;
+}
+
+// Filter/group-by/aggregate over BallColumns
+class BallQuery {
+public:
+    struct Predicate {
+        BallColumn column;
+        uint32_t value;
+    };
+
+    struct Aggregate {
+        uint64_t balls = 0;
+        uint64_t runs = 0;
+        uint64_t wickets = 0;
+
+        void merge(const Aggregate& other) {
+            balls += other.balls;
+            runs += other.runs;
+            wickets += other.wickets;
+        }
+
+        double getStrikeRate() const { return balls > 0 ? (double)runs * 100 / balls : 0.0; }
+    };
+
+    struct Result {
+        Aggregate total;
+        vector<Aggregate> groups;  // indexed by group value when grouping
+    };
+
+    vector<Predicate> predicates;
+    bool grouped = false;
+    BallColumn groupBy = BallColumn::STRIKER;
+
+private:
+    void scanRange(const BallColumns& c, size_t firstWord, size_t lastWord,
+                   uint64_t* selection, Result& result) const {
+        TraceSpan span("queryPartition", "words", (int64_t)(lastWord - firstWord));
+        const uint8_t* outcome = c.outcome.data();
+        const uint8_t* runs = c.runs.data();
+        const uint8_t wicket = (uint8_t)BallOutcome::WICKET;
+
+        for (size_t w = firstWord; w < lastWord; w++) {
+            size_t base = w * 64;
+            size_t count = min<size_t>(64, c.rows() - base);
+            uint64_t mask = count == 64 ? ~0ull : (1ull << count) - 1;
+
+            for (const auto& p : predicates) {
+                if (!mask) break;
+                mask &= BallColumns::isWide(p.column)
+                    ? FilterKernels::eq32(c.words(p.column) + base, count, p.value)
+                    : FilterKernels::eq8(c.bytes(p.column) + base, count, (uint8_t)p.value);
+            }
+            selection[w] = mask;
+            result.total.balls += __builtin_popcountll(mask);
+
+            while (mask) {
+                size_t row = base + __builtin_ctzll(mask);
+                mask &= mask - 1;
+                uint64_t isWicket = outcome[row] == wicket;
+                result.total.runs += runs[row];
+                result.total.wickets += isWicket;
+                if (grouped) {
+                    Aggregate& g = result.groups[c.value(groupBy, row)];
+                    g.balls++;
+                    g.runs += runs[row];
+                    g.wickets += isWicket;
+                }
+            }
+        }
+    }
+
+    size_t groupCount(const BallColumns& c) const {
+        if (!grouped) return 0;
+        return BallColumns::isWide(groupBy) ? (size_t)c.maxPlayerId + 1 : 256;
+    }
+
+public:
+    // Partitioned scan; selection receives one bit per matching row
+    Result run(const BallColumns& c, vector<uint64_t>& selection, unsigned threads = 1) const {
+        size_t wordCount = (c.rows() + 63) / 64;
+        selection.assign(wordCount, 0);
+        threads = max(1u, min<unsigned>(threads, (unsigned)max<size_t>(1, wordCount)));
+
+        vector<Result> partials(threads);
+        for (auto& partial : partials) partial.groups.resize(groupCount(c));
+        size_t perThread = (wordCount + threads - 1) / threads;
+        if (threads == 1) {
+            scanRange(c, 0, wordCount, selection.data(), partials[0]);
+            return partials[0];
+        }
+        
+        vector<thread> workers;
+        for (unsigned t = 0; t < threads; t++) {
+            size_t first = min(wordCount, t * perThread);
+            size_t last = min(wordCount, first + perThread);
+            workers.emplace_back([&, t, first, last] { scanRange(c, first, last, selection.data(), partials[t]); });
+        }
+        for (auto& w : workers) w.join();
+
+        Result result;
+        result.groups.resize(groupCount(c));
+        for (const auto& partial : partials) {
+            result.total.merge(partial.total);
+            for (size_t g = 0; g < partial.groups.size(); g++) result.groups[g].merge(partial.groups[g]);
+        }
+        return result;
+    }
+
+    // Reference row-at-a-time evaluation
+    Result runNaive(const BallColumns& c) const {
+        Result result;
+        result.groups.resize(groupCount(c));
+        for (size_t row = 0; row < c.rows(); row++) {
+            bool keep = true;
+            for (const auto& p : predicates) {
+                if (c.value(p.column, row) != p.value) {
+                    keep = false;
+                    break;
+                }
+            }
+            if (!keep) continue;
+
+            Aggregate a;
+            a.balls = 1;
+            a.runs = c.runs[row];
+            a.wickets = (BallOutcome)c.outcome[row] == BallOutcome::WICKET;
+            result.total.merge(a);
+            if (grouped) result.groups[c.value(groupBy, row)].merge(a);
+        }
+        return result;
+    }
+
+    static bool parseColumn(const string& name, BallColumn& column) {
+        static const pair<const char*, BallColumn> names[] = {
+            {"innings", BallColumn::INNINGS}, {"over", BallColumn::OVER},
+            {"wickets_down", BallColumn::WICKETS_DOWN}, {"outcome", BallColumn::OUTCOME},
+            {"striker_type", BallColumn::STRIKER_TYPE}, {"bowler_type", BallColumn::BOWLER_TYPE},
+            {"striker", BallColumn::STRIKER}, {"bowler", BallColumn::BOWLER}};
+        for (const auto& n : names) {
+            if (name == n.first) {
+                column = n.second;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Parse "col=value,col=value" (or "all"); values are the stored 0-based codes
+    bool parseFilter(const string& text) {
+        predicates.clear();
+        if (text == "all") return true;
+
+        size_t start = 0;
+        while (start < text.size()) {
+            size_t end = text.find(',', start);
+            if (end == string::npos) end = text.size();
+            string term = text.substr(start, end - start);
+            size_t eq = term.find('=');
+            Predicate p;
+            if (eq == string::npos || !parseColumn(term.substr(0, eq), p.column)) return false;
+            if (!parseNumber(string_view(term).substr(eq + 1), p.value)) return false;
+            predicates.push_back(p);
+            start = end + 1;
+        }
+        return true;
+    }
+};
+
+// Compressed bitmap of row numbers, split into 2^16-row chunks (roaring layout):
+// sparse chunks hold a sorted array of low 16 bits, dense chunks a 65536-bit bitmap
+class RoaringBitmap {
+private:
+    static const size_t ARRAY_MAX = 4096;
+    static const size_t BITMAP_WORDS = 1024;
+
+    struct Container {
+        vector<uint16_t> array;   // used while cardinality <= ARRAY_MAX
+        vector<uint64_t> bitmap;  // BITMAP_WORDS words once dense
+        uint32_t cardinality = 0;
+
+        bool isBitmap() const { return !bitmap.empty(); }
+
+        bool contains(uint16_t low) const {
+            if (isBitmap()) return (bitmap[low >> 6] >> (low & 63)) & 1;
+            return binary_search(array.begin(), array.end(), low);
+        }
+
+        void toBitmap() {
+            bitmap.assign(BITMAP_WORDS, 0);
+            for (uint16_t v : array) bitmap[v >> 6] |= 1ull << (v & 63);
+            array.clear();
+            array.shrink_to_fit();
+        }
+
+        // Drop back to an array once a bitmap becomes sparse
+        void normalize() {
+            if (!isBitmap() || cardinality > ARRAY_MAX) return;
+            array.reserve(cardinality);
+            for (size_t w = 0; w < BITMAP_WORDS; w++) {
+                for (uint64_t bits = bitmap[w]; bits; bits &= bits - 1) {
+                    array.push_back((uint16_t)(w * 64 + __builtin_ctzll(bits)));
+                }
+            }
+            bitmap.clear();
+            bitmap.shrink_to_fit();
+        }
+
+        void add(uint16_t low) {
+            if (isBitmap()) {
+                uint64_t& word = bitmap[low >> 6];
+                uint64_t bit = 1ull << (low & 63);
+                cardinality += (word & bit) == 0;
+                word |= bit;
+                return;
+            }
+            if (array.empty() || array.back() < low) {
+                array.push_back(low);
+            } else {
+                auto it = lower_bound(array.begin(), array.end(), low);
+                if (*it == low) return;
+                array.insert(it, low);
+            }
+            cardinality++;
+            if (cardinality > ARRAY_MAX) toBitmap();
+        }
+
+        // Expand into a scratch bitmap for mixed-representation operations
+        void fill(vector<uint64_t>& words) const {
+            if (isBitmap()) {
+                words = bitmap;
+                return;
+            }
+            words.assign(BITMAP_WORDS, 0);
+            for (uint16_t v : array) words[v >> 6] |= 1ull << (v & 63);
+        }
+
+        template <typename Fn>
+        void forEach(uint32_t high, Fn&& fn) const {
+            if (isBitmap()) {
+                for (size_t w = 0; w < BITMAP_WORDS; w++) {
+                    for (uint64_t bits = bitmap[w]; bits; bits &= bits - 1) {
+                        fn(high | (uint32_t)(w * 64 + __builtin_ctzll(bits)));
+                    }
+                }
+            } else {
+                for (uint16_t v : array) fn(high | v);
+            }
+        }
+    };
+
+    enum class Op { AND, OR, ANDNOT };
+
+    vector<uint16_t> keys;
+    vector<Container> containers;
+
+    static Container combine(const Container& a, const Container& b, Op op) {
+        Container out;
+        if (!a.isBitmap() && !b.isBitmap()) {
+            switch (op) {
+                case Op::AND:
+                    set_intersection(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(),
+                                     back_inserter(out.array));
+                    break;
+                case Op::OR:
+                    set_union(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(),
+                              back_inserter(out.array));
+                    break;
+                case Op::ANDNOT:
+                    set_difference(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(),
+                                   back_inserter(out.array));
+                    break;
+            }
+            out.cardinality = (uint32_t)out.array.size();
+            if (out.cardinality > ARRAY_MAX) out.toBitmap();
+            return out;
+        }
+
+        // A sparse array filtered against a dense bitmap stays an array
+        if (op != Op::OR && !a.isBitmap()) {
+            for (uint16_t v : a.array) {
+                if (b.contains(v) == (op == Op::AND)) out.array.push_back(v);
+            }
+            out.cardinality = (uint32_t)out.array.size();
+            return out;
+        }
+
+        vector<uint64_t> left, right;
+        a.fill(left);
+        b.fill(right);
+        out.bitmap.resize(BITMAP_WORDS);
+        uint32_t count = 0;
+        for (size_t w = 0; w < BITMAP_WORDS; w++) {
+            uint64_t word = op == Op::AND ? left[w] & right[w]
+                          : op == Op::OR ? left[w] | right[w]
+                          : left[w] & ~right[w];
+            out.bitmap[w] = word;
+            count += __builtin_popcountll(word);
+        }
+        out.cardinality = count;
+        out.normalize();
+        return out;
+    }
+
+    static RoaringBitmap apply(const RoaringBitmap& a, const RoaringBitmap& b, Op op) {
+        RoaringBitmap out;
+        size_t i = 0, j = 0;
+        while (i < a.keys.size() || j < b.keys.size()) {
+            bool takeA = j >= b.keys.size() || (i < a.keys.size() && a.keys[i] < b.keys[j]);
+            bool takeB = i >= a.keys.size() || (j < b.keys.size() && b.keys[j] < a.keys[i]);
+            if (takeA) {
+                if (op != Op::AND) out.push(a.keys[i], a.containers[i]);
+                i++;
+            } else if (takeB) {
+                if (op == Op::OR) out.push(b.keys[j], b.containers[j]);
+                j++;
+            } else {
+                Container c = combine(a.containers[i], b.containers[j], op);
+                if (c.cardinality > 0) out.push(a.keys[i], move(c));
+                i++;
+                j++;
+            }
+        }
+        return out;
+    }
+
+    void push(uint16_t key, Container c) {
+        keys.push_back(key);
+        containers.push_back(move(c));
+    }
+
+public:
+    void add(uint32_t row) {
+        uint16_t high = (uint16_t)(row >> 16);
+        size_t pos;
+        if (!keys.empty() && keys.back() == high) {
+            pos = keys.size() - 1;
+        } else if (keys.empty() || keys.back() < high) {
+            push(high, Container());
+            pos = keys.size() - 1;
+        } else {
+            auto it = lower_bound(keys.begin(), keys.end(), high);
+            pos = it - keys.begin();
+            if (it == keys.end() || *it != high) {
+                keys.insert(it, high);
+                containers.insert(containers.begin() + pos, Container());
+            }
+        }
+        containers[pos].add((uint16_t)row);
+    }
+
+    bool contains(uint32_t row) const {
+        auto it = lower_bound(keys.begin(), keys.end(), (uint16_t)(row >> 16));
+        return it != keys.end() && *it == (row >> 16) && containers[it - keys.begin()].contains((uint16_t)row);
+    }
+
+    uint64_t cardinality() const {
+        uint64_t total = 0;
+        for (const auto& c : containers) total += c.cardinality;
+        return total;
+    }
+
+    size_t sizeInBytes() const {
+        size_t bytes = keys.size() * sizeof(uint16_t);
+        for (const auto& c : containers) bytes += c.array.size() * 2 + c.bitmap.size() * 8;
+        return bytes;
+    }
+
+    RoaringBitmap operator&(const RoaringBitmap& other) const { return apply(*this, other, Op::AND); }
+    RoaringBitmap operator|(const RoaringBitmap& other) const { return apply(*this, other, Op::OR); }
+    RoaringBitmap andNot(const RoaringBitmap& other) const { return apply(*this, other, Op::ANDNOT); }
+
+    // Visit set rows in ascending order
+    template <typename Fn>
+    void forEach(Fn&& fn) const {
+        for (size_t i = 0; i < keys.size(); i++) containers[i].forEach((uint32_t)keys[i] << 16, fn);
+    }
+};
+
+// One roaring bitmap per distinct value of the bowler, striker, outcome and over columns
+class BallBitmapIndex {
+private:
+    vector<RoaringBitmap> byBowler;
+    vector<RoaringBitmap> byStriker;
+    vector<RoaringBitmap> byOutcome;
+    vector<RoaringBitmap> byOver;
+    RoaringBitmap empty;
+
+    const vector<RoaringBitmap>* bitmapsFor(BallColumn column) const {
+        switch (column) {
+            case BallColumn::BOWLER: return &byBowler;
+            case BallColumn::STRIKER: return &byStriker;
+            case BallColumn::OUTCOME: return &byOutcome;
+            case BallColumn::OVER: return &byOver;
+            default: return nullptr;
+        }
+    }
+
+public:
+    static bool isIndexed(BallColumn column) {
+        return column == BallColumn::BOWLER || column == BallColumn::STRIKER ||
+               column == BallColumn::OUTCOME || column == BallColumn::OVER;
+    }
+
+    static BallBitmapIndex build(const BallColumns& c) {
+        BallBitmapIndex index;
+        index.byBowler.resize(c.maxPlayerId + 1);
+        index.byStriker.resize(c.maxPlayerId + 1);
+        index.byOutcome.resize(7);
+        index.byOver.resize(256);
+        for (uint32_t row = 0; row < (uint32_t)c.rows(); row++) {
+            index.byBowler[c.bowler[row]].add(row);
+            index.byStriker[c.striker[row]].add(row);
+            index.byOutcome[c.outcome[row]].add(row);
+            index.byOver[c.over[row]].add(row);
+        }
+        return index;
+    }
+
+    const RoaringBitmap& lookup(BallColumn column, uint32_t value) const {
+        const vector<RoaringBitmap>* bitmaps = bitmapsFor(column);
+        if (!bitmaps || value >= bitmaps->size()) return empty;
+        return (*bitmaps)[value];
+    }
+
+    size_t sizeInBytes() const {
+        size_t bytes = 0;
+        for (const auto* list : {&byBowler, &byStriker, &byOutcome, &byOver}) {
+            for (const auto& b : *list) bytes += b.sizeInBytes();
+        }
+        return bytes;
+    }
+
+    // AND together the bitmaps of a conjunctive query (all columns must be indexed).
+    // No predicates selects every row: each row has exactly one outcome.
+    RoaringBitmap select(const vector<BallQuery::Predicate>& predicates) const {
+        if (predicates.empty()) {
+            RoaringBitmap all;
+            for (const auto& b : byOutcome) all = all | b;
+            return all;
+        }
+        RoaringBitmap result = lookup(predicates[0].column, predicates[0].value);
+        for (size_t i = 1; i < predicates.size(); i++) {
+            result = result & lookup(predicates[i].column, predicates[i].value);
+        }
+        return result;
+    }
+
+    // Aggregate only the selected rows
+    static BallQuery::Aggregate aggregate(const RoaringBitmap& rows, const BallColumns& c) {
+        BallQuery::Aggregate a;
+        a.balls = rows.cardinality();
+        rows.forEach([&](uint32_t row) {
+            a.runs += c.runs[row];
+            a.wickets += (BallOutcome)c.outcome[row] == BallOutcome::WICKET;
+        });
+        return a;
+    }
+};
+
+#if defined(__linux__)
+/*
+Score-streaming server: a single-threaded epoll reactor. A client subscribes by
+sending one byte, 'b' for binary frames or anything else for newline-delimited
+JSON. Each drained batch of ring events is encoded once per format and
+appended to every subscriber's buffer. Writes are non-blocking; a client with
+more than MAX_BUFFERED bytes unsent is disconnected, so slow readers never
+hold up the simulation or the other clients.
+
+Binary frame: [uint16 length][uint8 kind][payload], little-endian. The payload
+is the 16-byte BallEvent, or uint32 match id + uint8 team count + int16 points
+per team; END has no payload.
+*/
+class ScoreServer {
+private:
+    static const size_t MAX_BUFFERED = 1 << 20;
+    
+    enum Encoding : uint8_t { PENDING, JSON, BINARY };
+    
+    struct Client {
+        Encoding encoding = PENDING;
+        string out;
+        size_t sent = 0;
+        bool waitingWrite = false;  // EPOLLOUT armed
+    };
+    
+    int listenFd;
+    int epollFd;
+    string unixPath;
+    unordered_map<int, Client> clients;
+    size_t subscribers;
+    
+    uint64_t accepted;
+    uint64_t slowDisconnects;
+    uint64_t bytesSent;
+    uint64_t eventsSent;
+    
+    bool watch(int fd, uint32_t events, int op) {
+        epoll_event ev;
+        ev.events = events;
+        ev.data.fd = fd;
+        return epoll_ctl(epollFd, op, fd, &ev) == 0;
+    }
+    
+    void acceptAll() {
+        for (;;) {
+            int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) return;
+            // A client the reactor cannot watch would never be served
+            if (!watch(fd, EPOLLIN, EPOLL_CTL_ADD)) {
+                close(fd);
+                continue;
+            }
+            clients[fd] = Client();
+            accepted++;
+        }
+    }
+    
+    void closeClient(int fd) {
+        auto it = clients.find(fd);
+        if (it == clients.end()) return;
+        if (it->second.encoding != PENDING) subscribers--;
+        clients.erase(it);
+        close(fd);
+    }
+    
+    void readClient(int fd, Client& c) {
+        char buffer[256];
+        ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+        if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+            closeClient(fd);
+        } else if (n > 0 && c.encoding == PENDING) {
+            c.encoding = buffer[0] == 'b' ? BINARY : JSON;
+            subscribers++;
+        }
+    }
+    
+    // False if the client was closed
+    bool flushClient(int fd, Client& c) {
+        while (c.sent < c.out.size()) {
+            ssize_t n = send(fd, c.out.data() + c.sent, c.out.size() - c.sent, MSG_NOSIGNAL | MSG_DONTWAIT);
+            if (n < 0) {
+                if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                    closeClient(fd);
+                    return false;
+                }
+                if (!c.waitingWrite && !watch(fd, EPOLLIN | EPOLLOUT, EPOLL_CTL_MOD)) {
+                    closeClient(fd);
+                    return false;
+                }
+                c.waitingWrite = true;
+                return true;
+            }
+            c.sent += (size_t)n;
+            bytesSent += (uint64_t)n;
+        }
+        c.out.clear();
+        c.sent = 0;
+        if (c.waitingWrite && !watch(fd, EPOLLIN, EPOLL_CTL_MOD)) {
+            closeClient(fd);
+            return false;
+        }
+        c.waitingWrite = false;
+        return true;
+    }
+    
+    void publish(const string& json, const string& binary, uint64_t count) {
+        vector<int> slow;
+        for (auto& [fd, c] : clients) {
+            if (c.encoding == PENDING) continue;
+            const string& data = c.encoding == BINARY ? binary : json;
+            if (c.out.size() - c.sent + data.size() > MAX_BUFFERED) {
+                slow.push_back(fd);
+                continue;
+            }
+            if (c.sent > 0 && c.sent * 2 > c.out.size()) {
+                c.out.erase(0, c.sent);
+                c.sent = 0;
+            }
+            c.out += data;
+            eventsSent += count;
+        }
+        for (int fd : slow) {
+            closeClient(fd);
+            slowDisconnects++;
+        }
+        
+        vector<int> ready;
+        for (auto& [fd, c] : clients) {
+            if (!c.waitingWrite && c.sent < c.out.size()) ready.push_back(fd);
+        }
+        for (int fd : ready) flushClient(fd, clients[fd]);
+    }
+    
+    static void frame(string& out, uint8_t kind, const void* payload, uint16_t size) {
+        uint16_t length = (uint16_t)(size + 1);
+        out.append((const char*)&length, sizeof(length));
+        out += (char)kind;
+        out.append((const char*)payload, size);
+    }
+    
+    static void encode(const StreamEvent& e, string& json, string& binary) {
+        if (e.kind == StreamEvent::BALL) {
+            const BallEvent& b = e.ball;
+            BallOutcome outcome = (BallOutcome)b.outcome;
+            json += "{\"type\":\"ball\",\"match\":" + to_string(b.matchId) +
+                    ",\"innings\":" + to_string(b.innings) + ",\"ball\":" + to_string(b.ballIndex) +
+                    ",\"striker\":" + to_string(b.strikerId) + ",\"bowler\":" + to_string(b.bowlerId) +
+                    ",\"runs\":" + to_string(runsFor(outcome)) +
+                    ",\"wicket\":" + (outcome == BallOutcome::WICKET ? "true" : "false") + "}\n";
+            frame(binary, e.kind, &b, sizeof(b));
+        } else if (e.kind == StreamEvent::STANDINGS) {
+            json += "{\"type\":\"standings\",\"match\":" + to_string(e.matchId) + ",\"points\":[";
+            for (int t = 0; t < e.teamCount; t++) {
+                if (t) json += ',';
+                json += to_string(e.points[t]);
+            }
+            json += "]}\n";
+            
+            char payload[5 + sizeof(e.points)];
+            memcpy(payload, &e.matchId, 4);
+            payload[4] = (char)e.teamCount;
+            memcpy(payload + 5, e.points, e.teamCount * sizeof(int16_t));
+            frame(binary, e.kind, payload, (uint16_t)(5 + e.teamCount * sizeof(int16_t)));
+        } else {
+            json += "{\"type\":\"end\"}\n";
+            frame(binary, e.kind, nullptr, 0);
+        }
     }
-};
-
-// AllRounder class
-class AllRounder : public Player {
-private:
-    Batsman battingStats;
-    Bowler bowlingStats;
     
 public:
-    AllRounder(const string& name, int age) : Player(name, age, PlayerType::ALLROUNDER),
-        battingStats(name, age), bowlingStats(name, age) {}
+    ScoreServer() : listenFd(-1), epollFd(-1), subscribers(0), accepted(0), slowDisconnects(0),
+        bytesSent(0), eventsSent(0) {}
     
-    void updateCredits(int runs, int wickets) override {
-        matchCredits += runs / 20 + wickets;  // Both batting and bowling credits
-        totalCredits += runs / 20 + wickets;
+    ~ScoreServer() {
+        for (auto& [fd, c] : clients) close(fd);
+        if (listenFd >= 0) close(listenFd);
+        if (epollFd >= 0) close(epollFd);
+        if (!unixPath.empty()) unlink(unixPath.c_str());
     }
     
-    // Delegate methods
-    void addBattingRuns(int runs) { battingStats.addRuns(runs); }
-    void addBowlingWicket() { bowlingStats.addWicket(); }
-    void addBowlingRuns(int runs) { bowlingStats.addRuns(runs); }
+    ScoreServer(const ScoreServer&) = delete;
+    ScoreServer& operator=(const ScoreServer&) = delete;
     
-    void resetMatchStats() {
-        battingStats.resetMatchStats();
-        bowlingStats.resetMatchStats();
-        resetMatchCredits();
+    // "unix:PATH" or "tcp:PORT" (loopback only)
+    bool listenOn(const string& address) {
+        if (address.rfind("unix:", 0) == 0) {
+            sockaddr_un addr = {};
+            addr.sun_family = AF_UNIX;
+            string path = address.substr(5);
+            if (path.empty() || path.size() >= sizeof(addr.sun_path)) return false;
+            memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+            listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+            unlink(path.c_str());
+            if (listenFd < 0 || bind(listenFd, (sockaddr*)&addr, sizeof(addr)) != 0) return false;
+            unixPath = path;
+        } else if (address.rfind("tcp:", 0) == 0) {
+            sockaddr_in addr = {};
+            addr.sin_family = AF_INET;
+            uint16_t port;
+            if (!parseNumber(string_view(address).substr(4), port)) return false;
+            addr.sin_port = htons(port);
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            listenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+            int reuse = 1;
+            if (listenFd >= 0) setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+            if (listenFd < 0 || bind(listenFd, (sockaddr*)&addr, sizeof(addr)) != 0) return false;
+        } else {
+            return false;
+        }
+        
+        if (listen(listenFd, SOMAXCONN) != 0) return false;
+        epollFd = epoll_create1(EPOLL_CLOEXEC);
+        if (epollFd < 0) return false;
+        return watch(listenFd, EPOLLIN, EPOLL_CTL_ADD);
+    }
+    
+    /*
+    Serve until the stream is finished and every subscriber has its END (or
+    DRAIN_SECONDS pass). start is raised once minSubscribers have subscribed.
+    */
+    void run(ScoreStream& stream, size_t minSubscribers, atomic<bool>& start) {
+        const double DRAIN_SECONDS = 5;
+        epoll_event ready[256];
+        string json, binary;
+        bool ended = false;
+        chrono::steady_clock::time_point deadline;
+        
+        for (;;) {
+            int n = epoll_wait(epollFd, ready, 256, 1);
+            for (int i = 0; i < n; i++) {
+                int fd = ready[i].data.fd;
+                if (fd == listenFd) {
+                    acceptAll();
+                    continue;
+                }
+                auto it = clients.find(fd);
+                if (it == clients.end()) continue;
+                if (ready[i].events & (EPOLLERR | EPOLLHUP)) {
+                    closeClient(fd);
+                    continue;
+                }
+                if ((ready[i].events & EPOLLOUT) && !flushClient(fd, it->second)) continue;
+                if (ready[i].events & EPOLLIN) readClient(fd, it->second);
+            }
+            if (subscribers >= minSubscribers) start.store(true, memory_order_release);
+            
+            if (!ended) {
+                json.clear();
+                binary.clear();
+                uint64_t count = 0;
+                StreamEvent event;
+                while (count < 4096 && stream.poll(event)) {
+                    encode(event, json, binary);
+                    count++;
+                }
+                if (count == 0 && stream.isFinished()) {
+                    event.kind = StreamEvent::END;
+                    encode(event, json, binary);
+                    count = 1;
+                    ended = true;
+                    deadline = chrono::steady_clock::now() + chrono::duration_cast<chrono::steady_clock::duration>(
+                                   chrono::duration<double>(DRAIN_SECONDS));
+                }
+                if (count > 0) publish(json, binary, count);
+            }
+            
+            if (ended) {
+                bool drained = true;
+                for (auto& [fd, c] : clients) drained = drained && c.sent == c.out.size();
+                if (drained || chrono::steady_clock::now() > deadline) return;
+            }
+        }
     }
+    
+    uint64_t getAccepted() const { return accepted; }
+    uint64_t getSlowDisconnects() const { return slowDisconnects; }
+    uint64_t getBytesSent() const { return bytesSent; }
+    uint64_t getEventsSent() const { return eventsSent; }
 };
 
-// Team class
-class Team {
+/*
+Hardware counters for the calling thread via perf_event_open. Each event is
+opened on its own so a PMU that lacks one (or a VM without a PMU) still
+reports the rest (task-clock is a software event and opens everywhere); counts are scaled when the kernel multiplexes them.
+User space only, so perf_event_paranoid up to 2 is enough.
+*/
+class HardwareCounters {
+public:
+    enum Event { CYCLES, INSTRUCTIONS, BRANCHES, BRANCH_MISSES, L1D_MISSES, LLC_MISSES, TASK_CLOCK_NS, COUNT };
+    
 private:
-    string name;
-    string city;
-    vector<shared_ptr<Player>> roster;  // 5 players
-    vector<shared_ptr<Player>> playing5;  // 5 players
-    int points;
-    int matchesPlayed;
-    int matchesWon;
-    int matchesLost;
-    int matchesTied;
+    int fds[COUNT];
+    uint64_t values[COUNT];
+    int openError;          // errno of the first event that failed to open
     
-public:
-    Team(const string& n, const string& c) : name(n), city(c), points(0), 
-        matchesPlayed(0), matchesWon(0), matchesLost(0), matchesTied(0) {}
+    int openEvent(uint32_t type, uint64_t config) {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        int fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        if (fd < 0 && !openError) openError = errno;
+        return fd;
+    }
     
-    // Team management
-    void addPlayer(shared_ptr<Player> player) {
-        roster.push_back(player);
+    static uint64_t cacheMisses(uint64_t cache) {
+        return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
     }
     
-    void selectPlaying5() {
-        playing5 = roster;  // All 5 players play
+public:
+    HardwareCounters() : openError(0) {
+        fds[CYCLES] = openEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+        fds[INSTRUCTIONS] = openEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+        fds[BRANCHES] = openEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_INSTRUCTIONS);
+        fds[BRANCH_MISSES] = openEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+        fds[L1D_MISSES] = openEvent(PERF_TYPE_HW_CACHE, cacheMisses(PERF_COUNT_HW_CACHE_L1D));
+        fds[LLC_MISSES] = openEvent(PERF_TYPE_HW_CACHE, cacheMisses(PERF_COUNT_HW_CACHE_LL));
+        fds[TASK_CLOCK_NS] = openEvent(PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK);
+        memset(values, 0, sizeof(values));
     }
     
-    bool validatePlaying5() const {
-        int bowlers = 0, batsmen = 0;
-        for (const auto& player : playing5) {
-            if (player->isBowler()) bowlers++;
-            if (player->isBatsman()) batsmen++;
+    ~HardwareCounters() {
+        for (int fd : fds) {
+            if (fd >= 0) close(fd);
         }
-        return bowlers >= 2 && batsmen >= 2;
     }
     
-    // Match results
-    void addPoints(int pts) { points += pts; }
+    HardwareCounters(const HardwareCounters&) = delete;
+    HardwareCounters& operator=(const HardwareCounters&) = delete;
     
-    void updateMatchResult(MatchResult result) {
-        matchesPlayed++;
-        switch (result) {
-            case MatchResult::WIN: matchesWon++; break;
-            case MatchResult::LOSS: matchesLost++; break;
-            case MatchResult::TIE: matchesTied++; break;
-            default: break;
+    bool available(Event e) const { return fds[e] >= 0; }
+    bool anyAvailable() const {
+        for (int fd : fds) {
+            if (fd >= 0) return true;
         }
+        return false;
     }
     
-    // Getters
-    string getName() const { return name; }
-    vector<shared_ptr<Player>> getPlaying5() const { return playing5; }
-    int getPoints() const { return points; }
-    double getWinPercentage() const {
-        return matchesPlayed > 0 ? (double)matchesWon * 100 / matchesPlayed : 0.0;
+    void start() {
+        for (int fd : fds) {
+            if (fd < 0) continue;
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
     }
     
-    // Player search
-    shared_ptr<Player> findPlayer(const string& playerName) const {
-        for (const auto& player : playing5) {
-            if (player->getName() == playerName) return player;
+    void stop() {
+        for (int e = 0; e < COUNT; e++) {
+            if (fds[e] < 0) continue;
+            ioctl(fds[e], PERF_EVENT_IOC_DISABLE, 0);
+            uint64_t data[3] = {0, 0, 0};  // value, time enabled, time running
+            values[e] = 0;
+            if (read(fds[e], data, sizeof(data)) != (ssize_t)sizeof(data) || data[2] == 0) continue;
+            values[e] = data[2] < data[1] ? (uint64_t)((double)data[0] * data[1] / data[2]) : data[0];
         }
-        return nullptr;
     }
+    
+    uint64_t get(Event e) const { return values[e]; }
+    int getOpenError() const { return openError; }
 };
+#endif
 
-// Innings class to manage one team's batting
-class Innings {
-private:
-    Team* battingTeam;
-    Team* bowlingTeam;
-    vector<shared_ptr<Player>> battingOrder;
-    vector<shared_ptr<Player>> bowlingOrder;
-    
-    int currentBatsman1;
-    int currentBatsman2;
-    int currentBowler;
-    int previousBowler;
-    
-    int totalRuns;
-    int totalWickets;
-    int totalOvers;
-    int totalBalls;
-    int currentOverBalls;
-    
-    map<shared_ptr<Player>, int> playerRuns;
-    map<shared_ptr<Player>, int> playerWickets;
-    
-    // Random ball outcome vector
-    vector<int> ballOutcomes = {0, 1, 2, 3, 4, 5, 6};  // 5 = wicket
+// Command-line settings
+struct RunOptions {
+    string ballLogPath;
+    string archivePath;
+    string scanPath;
+    string replayPath;
+    uint64_t replayIndex = 0;
+    string queryPath;
+    string exportDir;
+    string exportBallsPath;
+    string careerDir;
+    string analyzePath;
+    string analyzeFilter;
+    string groupBy;
+    unsigned threads = max(1u, thread::hardware_concurrency());
+    bool useIndex = false;
+    string checkpointPath;
+    string resumePath;
+    bool autoPlayers = false;
+    bool variedCommentary = false;
+    bool seeded = false;
+    uint32_t seed = 0;
+    int seasons = 0;
+    string whatIf;
+    int chasing = -1;
+    uint64_t forks = 100000;
+    string scenarios;
+    uint64_t monteCarloRuns = 10000;
+    string livePath;
+    int leagueTeams = 10;
+    int leagueMatches = 70;
+    int matchDay = 0;
+    string serveAddress;
+    bool stats = false;
+    string tracePath;
+    string commentaryPath;
+    bool profile = false;
+    int allocationBudget = -1;  // per match; checked when >= 0
+    bool bench = false;
+    size_t subscribers = 0;
+    int paceMs = 0;
+};
+
+// Batch mode: play whole seasons without prompts or commentary
+int runSeasons(const RunOptions& options, BallLog* ballLog, PackedArchive* archive, CareerStore* careers) {
+    int seasons = options.seasons;
+    auto start = chrono::steady_clock::now();
+    uint32_t nextMatchId = 0;
     
-public:
-    Innings(Team* batting, Team* bowling) : battingTeam(batting), bowlingTeam(bowling),
-        currentBatsman1(0), currentBatsman2(1), currentBowler(0), previousBowler(-1),
-        totalRuns(0), totalWickets(0), totalOvers(0), totalBalls(0), currentOverBalls(0) {
+    for (int s = 0; s < seasons; s++) {
+        Tournament tournament("IPL Mini Tournament");
+        tournament.setInteractive(false);
+        tournament.setVerbose(false);
+        if (options.seeded) tournament.setSeed(options.seed + s);
+        tournament.attachBallLog(ballLog, nextMatchId);
+        tournament.attachArchive(archive);
+        
+        tournament.createTeams();
+        tournament.createDefaultPlayers();
+        tournament.generateFixtures();
+        tournament.playTournament();
         
-        battingOrder = batting->getPlaying5();
-        bowlingOrder = bowling->getPlaying5();
+        nextMatchId += (uint32_t)tournament.getMatchCount();
         
-        // Initialize player stats
-        for (auto& player : battingOrder) {
-            playerRuns[player] = 0;
+        if (careers && !careers->recordTournament(tournament.getPlayers())) {
+            cerr << "Cannot write career store " << options.careerDir << endl;
+            return 1;
         }
-        for (auto& player : bowlingOrder) {
-            playerWickets[player] = 0;
+        
+        if (s == seasons - 1 && !options.exportDir.empty() &&
+            !StatsExporter::exportTournament(tournament, options.exportDir)) {
+            cerr << "Cannot export to " << options.exportDir << endl;
+            return 1;
         }
     }
     
-    // Setup methods
-    void setBatsmen(const string& striker, const string& nonStriker) {
-        for (int i = 0; i < battingOrder.size(); i++) {
-            if (battingOrder[i]->getName() == striker) currentBatsman1 = i;
-            if (battingOrder[i]->getName() == nonStriker) currentBatsman2 = i;
-        }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << "Simulated " << seasons << " seasons (" << nextMatchId << " matches) in "
+         << fixed << setprecision(3) << seconds << " s" << endl;
+    if (ballLog) {
+        cout << "Logged " << ballLog->getTotalEvents() << " ball events ("
+             << setprecision(1) << ballLog->getTotalEvents() / seconds / 1e6 << " M events/s)" << endl;
+    }
+    if (archive) {
+        cout << "Archived " << archive->getInningsCount() << " innings ("
+             << archive->getInningsCount() * sizeof(uint64_t) << " bytes)" << endl;
+    }
+    return 0;
+}
+
+// Archival runs: batch seasons with full commentary written to a file. Seasons
+// are dealt round-robin to the threads, and the file holds them in season order.
+int archiveCommentary(const RunOptions& options) {
+    int seasons = max(1, options.seasons);
+    unsigned threads = max(1u, min<unsigned>(options.threads, (unsigned)seasons));
+    
+    CommentaryArchive archive;
+    if (!archive.open(options.commentaryPath)) {
+        cerr << "Cannot open commentary file " << options.commentaryPath << endl;
+        return 1;
     }
     
-    void setBowler(const string& bowlerName) {
-        for (int i = 0; i < bowlingOrder.size(); i++) {
-            if (bowlingOrder[i]->getName() == bowlerName) currentBowler = i;
+    auto start = chrono::steady_clock::now();
+    atomic<uint64_t> matchCount(0);
+    auto worker = [&](unsigned t) {
+        CommentaryRegion region;
+        for (int s = (int)t; s < seasons; s += (int)threads) {
+            Tournament tournament("IPL Mini Tournament");
+            tournament.setInteractive(false);
+            tournament.setVerbose(false);
+            tournament.setVariedCommentary(options.variedCommentary);
+            if (options.seeded) tournament.setSeed(options.seed + s);
+            tournament.attachCommentary(&region);
+            
+            // Match ids run on across seasons as in a single-threaded batch
+            tournament.createTeams();
+            size_t teamCount = tournament.getTeams().size();
+            tournament.attachBallLog(nullptr, (uint32_t)(s * teamCount * (teamCount - 1) / 2));
+            tournament.createDefaultPlayers();
+            tournament.generateFixtures();
+            tournament.playTournament();
+            
+            matchCount.fetch_add(tournament.getMatchCount(), memory_order_relaxed);
+            if (!archive.submit((uint64_t)s, region.take())) break;
+        }
+    };
+    
+    vector<thread> workers;
+    for (unsigned t = 1; t < threads; t++) workers.emplace_back(worker, t);
+    worker(0);
+    for (auto& w : workers) w.join();
+    
+    uint64_t bytes = archive.size();
+    if (!archive.close()) {
+        cerr << "Cannot write commentary file " << options.commentaryPath << endl;
+        return 1;
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << "Archived commentary for " << seasons << " seasons (" << matchCount.load() << " matches) on "
+         << threads << " threads in " << fixed << setprecision(3) << seconds << " s" << endl;
+    cout << "Wrote " << bytes << " bytes (" << setprecision(1) << bytes / seconds / 1e6 << " MB/s)" << endl;
+    cout.unsetf(ios::floatfield);
+    return 0;
+}
+
+#if defined(__linux__)
+// One line of the profile table; per-unit columns are skipped when the unit count is zero
+void printProfileRow(const char* phase, const HardwareCounters& counters, const uint64_t* totals,
+                     uint64_t balls, uint64_t matches) {
+    static const char* names[] = {"cycles", "instructions", "branches", "branch-misses", "L1d-misses", "LLC-misses",
+                                  "task-clock-ns"};
+    static_assert(sizeof(names) / sizeof(names[0]) == HardwareCounters::COUNT, "counter names");
+    cout << "\n[" << phase << "]" << endl;
+    for (int e = 0; e < HardwareCounters::COUNT; e++) {
+        cout << "  " << left << setw(14) << names[e] << right;
+        if (!counters.available((HardwareCounters::Event)e)) {
+            cout << setw(16) << "n/a" << endl;
+            continue;
         }
+        uint64_t value = totals[e];
+        cout << setw(16) << value;
+        if (balls) cout << setw(12) << fixed << setprecision(2) << (double)value / balls << " /ball";
+        if (matches) cout << setw(14) << fixed << setprecision(1) << (double)value / matches << " /match";
+        cout << endl;
+    }
+    if (counters.available(HardwareCounters::CYCLES) && counters.available(HardwareCounters::INSTRUCTIONS) &&
+        totals[HardwareCounters::CYCLES]) {
+        cout << "  IPC " << setprecision(2)
+             << (double)totals[HardwareCounters::INSTRUCTIONS] / totals[HardwareCounters::CYCLES];
+        if (counters.available(HardwareCounters::BRANCHES) && counters.available(HardwareCounters::BRANCH_MISSES) &&
+            totals[HardwareCounters::BRANCHES]) {
+            cout << " | branch-miss rate " << setprecision(3)
+                 << 100.0 * totals[HardwareCounters::BRANCH_MISSES] / totals[HardwareCounters::BRANCHES] << "%";
+        }
+        cout << endl;
+    }
+    cout.unsetf(ios::floatfield);
+}
+#endif
+
+// Profile mode: batch seasons with hardware counters around the setup and play phases
+int profileSeasons(const RunOptions& options) {
+#if defined(__linux__)
+    HardwareCounters setupCounters, playCounters;
+    if (!playCounters.available(HardwareCounters::CYCLES)) {
+        cout << "No hardware PMU events (" << strerror(playCounters.getOpenError())
+             << "); reporting software counters only" << endl;
+    }
+    if (!playCounters.anyAvailable()) {
+        cerr << "perf_event_open failed (" << strerror(playCounters.getOpenError())
+             << "); check kernel.perf_event_paranoid" << endl;
+        return 1;
     }
     
-    // Game logic
-    void playBall() {
-        if (isInningsComplete()) return;
+    int seasons = options.seasons > 0 ? options.seasons : 200;
+    uint64_t matches = 0, balls = 0;
+    uint64_t setupTotals[HardwareCounters::COUNT] = {}, playTotals[HardwareCounters::COUNT] = {};
+    auto accumulate = [](uint64_t* totals, const HardwareCounters& counters) {
+        for (int e = 0; e < HardwareCounters::COUNT; e++) totals[e] += counters.get((HardwareCounters::Event)e);
+    };
+    
+    auto begin = chrono::steady_clock::now();
+    for (int s = 0; s < seasons; s++) {
+        Tournament tournament("IPL Mini Tournament");
+        tournament.setInteractive(false);
+        tournament.setVerbose(false);
+        if (options.seeded) tournament.setSeed(options.seed + s);
         
-        // Random ball outcome
-        random_device rd;
-        mt19937 gen(rd());
-        uniform_int_distribution<> dis(0, ballOutcomes.size() - 1);
-        int outcome = ballOutcomes[dis(gen)];
+        setupCounters.start();
+        tournament.createTeams();
+        tournament.createDefaultPlayers();
+        tournament.generateFixtures();
+        setupCounters.stop();
+        accumulate(setupTotals, setupCounters);
         
-        // Update statistics based on outcome
-        if (outcome == 5) {  // Wicket
-            totalWickets++;
-            playerWickets[bowlingOrder[currentBowler]]++;
-            bowlingOrder[currentBowler]->addWicket();
-            bowlingOrder[currentBowler]->addBall();
-            
-            // Change batsman
-            changeBatsman();
+        // Balls come from the runtime counters, which also see every delivery of the season
+        uint64_t ballsBefore = SimStats::read(Counter::BALLS);
+        playCounters.start();
+        tournament.playTournament();
+        playCounters.stop();
+        accumulate(playTotals, playCounters);
+        balls += SimStats::read(Counter::BALLS) - ballsBefore;
+        matches += tournament.getMatchCount();
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+    
+    cout << "Profiled " << seasons << " seasons (" << matches << " matches, " << balls << " balls) in "
+         << fixed << setprecision(3) << seconds << " s";
+    if (balls) cout << " | " << setprecision(1) << seconds * 1e9 / balls << " ns/ball wall";
+    cout << endl;
+    cout.unsetf(ios::floatfield);
+    
+    printProfileRow("setup", setupCounters, setupTotals, 0, matches);
+    printProfileRow("play", playCounters, playTotals, balls, matches);
+    return 0;
+#else
+    (void)options;
+    cerr << "Profile mode needs perf_event_open (Linux)" << endl;
+    return 1;
+#endif
+}
+
+// Ball-loop benchmark: wall time of the play phase only, best and median of 5 runs
+int benchmarkBallLoop(const RunOptions& options) {
+    int seasons = options.seasons > 0 ? options.seasons : 5000;
+    vector<double> nsPerBall;
+    
+    for (int run = 0; run < 5; run++) {
+        uint64_t balls = 0;
+        chrono::steady_clock::duration playing{0};
+        for (int s = 0; s < seasons; s++) {
+            Tournament tournament("IPL Mini Tournament");
+            tournament.setInteractive(false);
+            tournament.setVerbose(false);
+            tournament.setSeed((options.seeded ? options.seed : 0) + s);
+            tournament.createTeams();
+            tournament.createDefaultPlayers();
+            tournament.generateFixtures();
             
-            printCommentary(totalBalls + 1, 0, true);
-        } else {  // Runs
-            totalRuns += outcome;
-            playerRuns[battingOrder[currentBatsman1]] += outcome;
-            battingOrder[currentBatsman1]->addRuns(outcome);
-            battingOrder[currentBatsman1]->addBall();
+            auto start = chrono::steady_clock::now();
+            tournament.playTournament();
+            playing += chrono::steady_clock::now() - start;
             
-            // Change strike on odd runs
-            if (outcome % 2 == 1) {
-                changeStrike();
+            for (const Match* match : tournament.getMatches()) {
+                balls += match->getFirstInnings().getState().balls + match->getSecondInnings().getState().balls;
             }
-            
-            printCommentary(totalBalls + 1, outcome, false);
-        }
-        
-        // Update ball count
-        totalBalls++;
-        currentOverBalls++;
-        bowlingOrder[currentBowler]->addBall();
-        
-        // Change bowler every 6 balls
-        if (currentOverBalls == 6) {
-            changeBowler();
-            currentOverBalls = 0;
-            totalOvers++;
         }
+        nsPerBall.push_back(chrono::duration<double, nano>(playing).count() / max<uint64_t>(balls, 1));
     }
     
-    void changeStrike() {
-        swap(currentBatsman1, currentBatsman2);
+    sort(nsPerBall.begin(), nsPerBall.end());
+    cout << "Ball loop over " << seasons << " seasons x 5: best " << fixed << setprecision(2) << nsPerBall[0]
+         << " ns/ball, median " << nsPerBall[2] << " ns/ball" << endl;
+    
+    // Commentary formatting alone: ball lines for a prepared set of events, no output
+    const int EVENTS = 84, LINES = 1 << 20;
+    GameEvent events[EVENTS] = {};
+    for (int i = 0; i < EVENTS; i++) {
+        events[i].kind = GameEvent::BALL;
+        events[i].outcome = (uint8_t)(i % 7);
+        events[i].state.balls = (uint8_t)(i % 12 + 1);
+        events[i].state.overBalls = (uint8_t)(i % 6);
+        events[i].state.overs = (uint8_t)(i % 12 / 6 + 1);
+        events[i].state.runs = (uint16_t)(i % 40);
+        events[i].state.wickets = (uint8_t)(i % 3);
+    }
+    char line[CommentaryFormatter::MAX_LINE];
+    uint64_t bytes = 0;
+    auto start = chrono::steady_clock::now();
+    for (int i = 0, e = 0; i < LINES; i++, e = e + 1 == EVENTS ? 0 : e + 1) {
+        bytes += CommentaryFormatter::formatBall(events[e], "Ruturaj", "Bumrah", e & 1, line);
     }
+    double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / LINES;
+    cout << "Commentary formatting: " << ns << " ns/line (" << bytes / LINES << " bytes/line)" << endl;
+    cout.unsetf(ios::floatfield);
+    return 0;
+}
+
+// Allocation check: no match of the batch seasons may allocate more than the budget
+int checkAllocations(const RunOptions& options, BallLog* ballLog) {
+#if TOURNAMENT_STATS
+    int seasons = options.seasons > 0 ? options.seasons : 20;
+    uint64_t budget = (uint64_t)options.allocationBudget;
+    uint64_t matches = 0, total = 0, worst = 0, overBudget = 0;
+    ScoreStream stream;
     
-    void changeBatsman() {
-        int nextBatsman = max(currentBatsman1, currentBatsman2) + 1;
-        if (nextBatsman < battingOrder.size()) {
-            if (currentBatsman1 > currentBatsman2) {
-                currentBatsman1 = nextBatsman;
-            } else {
-                currentBatsman2 = nextBatsman;
+    for (int s = 0; s < seasons; s++) {
+        Tournament tournament("IPL Mini Tournament");
+        tournament.setInteractive(false);
+        tournament.setVerbose(false);
+        if (options.seeded) tournament.setSeed(options.seed + s);
+        tournament.attachBallLog(ballLog, (uint32_t)matches);
+        tournament.attachStream(&stream);
+        tournament.createTeams();
+        tournament.createDefaultPlayers();
+        tournament.generateFixtures();
+        if (ballLog && s == 0) ballLog->reserveMatches((size_t)seasons * tournament.getMatchCount());
+        
+        for (size_t m = 0; m < tournament.getMatchCount(); m++) {
+            uint64_t before = SimStats::read(Counter::ALLOCATIONS);
+            tournament.playRound();
+            uint64_t allocations = SimStats::read(Counter::ALLOCATIONS) - before;
+            
+            total += allocations;
+            worst = max(worst, allocations);
+            if (allocations > budget) {
+                if (overBudget++ < 5) {
+                    cerr << "Season " << s + 1 << " match " << m + 1 << ": " << allocations
+                         << " allocations (budget " << budget << ")" << endl;
+                }
             }
+            StreamEvent drained;
+            while (stream.poll(drained)) {}
         }
+        matches += tournament.getMatchCount();
     }
     
-    void changeBowler() {
-        previousBowler = currentBowler;
-        do {
-            currentBowler = (currentBowler + 1) % bowlingOrder.size();
-        } while (currentBowler == previousBowler);
+    cout << "Checked " << matches << " matches: " << total << " allocations, worst match " << worst
+         << ", budget " << budget << endl;
+    if (overBudget) {
+        cerr << overBudget << " matches over the allocation budget" << endl;
+        return 1;
     }
+    return 0;
+#else
+    (void)options;
+    (void)ballLog;
+    cerr << "Allocation checks need the runtime counters (TOURNAMENT_STATS=1)" << endl;
+    return 1;
+#endif
+}
+
+// Career totals (all recorded tournaments) for the given players
+void displayCareerStats(const CareerStore& careers, const vector<shared_ptr<Player>>& players) {
+    cout << "\n=== CAREER STATISTICS ===" << endl;
+    cout << setw(20) << "Name" << setw(8) << "Tourn" << setw(10) << "Runs" << setw(10) << "Balls"
+         << setw(10) << "Wickets" << setw(10) << "Credits" << endl;
+    cout << "------------------------------------------------------------------" << endl;
     
-    bool isInningsComplete() const {
-        return totalWickets >= 2 || totalOvers >= 2;
+    for (const auto& player : players) {
+        CareerRecord record;
+        if (!careers.lookup(player->getName(), record)) continue;
+        cout << setw(20) << player->getName()
+             << setw(8) << record.tournaments
+             << setw(10) << record.runs
+             << setw(10) << record.ballsFaced
+             << setw(10) << record.wickets
+             << setw(10) << record.credits << endl;
+    }
+}
+
+// Replay one logged match against the default batch rosters
+int replayLoggedMatch(const string& path, uint64_t k) {
+    MappedBallLog log;
+    if (!log.open(path)) {
+        cerr << "Cannot read ball log " << path << endl;
+        return 1;
     }
     
-    // Getters
-    int getTotalRuns() const { return totalRuns; }
-    int getTotalWickets() const { return totalWickets; }
+    Tournament tournament("IPL Mini Tournament");
+    tournament.setInteractive(false);
+    tournament.createTeams();
+    tournament.createDefaultPlayers();
+    tournament.generateFixtures();
     
-    shared_ptr<Player> getPlayerOfInnings() const {
-        shared_ptr<Player> bestPlayer = nullptr;
-        int maxCredits = -1;
-        
-        for (const auto& player : battingOrder) {
-            if (player->getMatchCredits() > maxCredits) {
-                maxCredits = player->getMatchCredits();
-                bestPlayer = player;
-            }
+    if (!tournament.replayMatch(log, k)) {
+        cerr << "Match " << k << " not in log (" << log.getMatchCount() << " matches)" << endl;
+        return 1;
+    }
+    return 0;
+}
+
+// Aggregate queries over a mapped ball log
+int queryBallLog(const string& path) {
+    MappedBallLog log;
+    if (!log.open(path)) {
+        cerr << "Cannot read ball log " << path << endl;
+        return 1;
+    }
+    
+    for (uint64_t b = 0; b < log.getBlockCount(); b++) {
+        if (!log.verifyBlock(b)) {
+            cerr << "Checksum mismatch in block " << b << endl;
+            return 1;
         }
-        
-        for (const auto& player : bowlingOrder) {
-            if (player->getMatchCredits() > maxCredits) {
-                maxCredits = player->getMatchCredits();
-                bestPlayer = player;
-            }
+    }
+    
+    cout << "Matches: " << log.getMatchCount() << " | Balls: " << log.getEventCount() << endl;
+    
+    cout << "\n=== RUNS PER OVER ===" << endl;
+    auto runs = BallLogQueries::runsPerOver(log);
+    for (size_t over = 0; over < runs.size(); over++) {
+        cout << "Over " << (over + 1) << ": " << runs[over] << endl;
+    }
+    
+    cout << "\n=== WICKETS PER BOWLER ===" << endl;
+    auto wickets = BallLogQueries::wicketsPerBowler(log);
+    for (size_t id = 0; id < wickets.size(); id++) {
+        if (wickets[id] > 0) cout << "Player " << id << ": " << wickets[id] << endl;
+    }
+    
+    cout << "\n=== INNINGS SCORE HISTOGRAM ===" << endl;
+    auto histogram = BallLogQueries::scoreHistogram(log);
+    for (size_t score = 0; score < histogram.size(); score++) {
+        if (histogram[score] > 0) cout << setw(3) << score << ": " << histogram[score] << endl;
+    }
+    return 0;
+}
+
+// Stream the ball-level table of a log to CSV and columnar files
+int exportBallLog(const string& path, const string& dir) {
+    PhaseTimer timer(Counter::EXPORT_NS);
+    TraceSpan span("exportBallLog");
+    MappedBallLog log;
+    if (!log.open(path)) {
+        cerr << "Cannot read ball log " << path << endl;
+        return 1;
+    }
+    
+    auto start = chrono::steady_clock::now();
+    if (!StatsExporter::exportBalls(log, dir)) {
+        cerr << "Cannot export to " << dir << endl;
+        return 1;
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << "Exported " << log.getEventCount() << " balls in " << fixed << setprecision(3) << seconds << " s" << endl;
+    return 0;
+}
+
+// Filter/group-by query over a ball log, compared against a row-at-a-time loop
+int analyzeBallLog(const RunOptions& options) {
+    MappedBallLog log;
+    if (!log.open(options.analyzePath)) {
+        cerr << "Cannot read ball log " << options.analyzePath << endl;
+        return 1;
+    }
+    
+    BallQuery query;
+    if (!query.parseFilter(options.analyzeFilter) ||
+        (!options.groupBy.empty() && !BallQuery::parseColumn(options.groupBy, query.groupBy))) {
+        cerr << "Bad query. Columns: innings, over, wickets_down, outcome, striker_type, "
+             << "bowler_type, striker, bowler" << endl;
+        return 1;
+    }
+    query.grouped = !options.groupBy.empty();
+    
+    // Player types come from the default batch rosters the log was written with
+    Tournament rosters("IPL Mini Tournament");
+    rosters.createTeams();
+    rosters.createDefaultPlayers();
+    vector<PlayerType> playerTypes;
+    for (const auto& player : rosters.getPlayers()) playerTypes.push_back(player->getType());
+    
+    BallColumns columns = BallColumns::fromLog(log, playerTypes);
+    
+    vector<uint64_t> selection;
+    auto start = chrono::steady_clock::now();
+    BallQuery::Result result = query.run(columns, selection, options.threads);
+    double vectorSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    
+    start = chrono::steady_clock::now();
+    BallQuery::Result naive = query.runNaive(columns);
+    double naiveSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    
+    cout << "Rows: " << columns.rows() << " | Selected: " << result.total.balls
+         << " | Runs: " << result.total.runs << " | Wickets: " << result.total.wickets
+         << " | Strike rate: " << fixed << setprecision(2) << result.total.getStrikeRate() << endl;
+    
+    if (query.grouped) {
+        for (size_t g = 0; g < result.groups.size(); g++) {
+            const auto& a = result.groups[g];
+            if (a.balls == 0) continue;
+            cout << setw(6) << g << ": balls " << setw(8) << a.balls << "  runs " << setw(8) << a.runs
+                 << "  wickets " << setw(6) << a.wickets << "  SR " << a.getStrikeRate() << endl;
         }
-        
-        return bestPlayer;
     }
     
-    // Commentary
-    void printCommentary(int ballNumber, int runs, bool isWicket) {
-        string striker = battingOrder[currentBatsman1]->getName();
-        string bowler = bowlingOrder[currentBowler]->getName();
+    cout << "Vectorized: " << setprecision(3) << vectorSeconds * 1e3 << " ms (" << options.threads
+         << " threads) | Row loop: " << naiveSeconds * 1e3 << " ms";
+    if (naive.total.balls != result.total.balls || naive.total.runs != result.total.runs) cout << " | MISMATCH";
+    cout << endl;
+    
+    if (options.useIndex && !query.predicates.empty()) {
+        for (const auto& p : query.predicates) {
+            if (!BallBitmapIndex::isIndexed(p.column)) {
+                cerr << "Indexed columns: bowler, striker, outcome, over" << endl;
+                return 1;
+            }
+        }
         
-        cout << "Ball " << ballNumber << ": ";
+        start = chrono::steady_clock::now();
+        BallBitmapIndex index = BallBitmapIndex::build(columns);
+        double buildSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
         
-        if (isWicket) {
-            cout << "WICKET! " << striker << " is out! Bowled by " << bowler << endl;
-        } else if (runs == 0) {
-            cout << "Dot ball. " << striker << " defends" << endl;
-        } else if (runs == 1) {
-            cout << "Single. " << striker << " takes a quick run" << endl;
-        } else if (runs == 2) {
-            cout << "Two runs. " << striker << " pushes for a couple" << endl;
-        } else if (runs == 3) {
-            cout << "Three runs. " << striker << " runs hard for three" << endl;
-        } else if (runs == 4) {
-            cout << "FOUR! " << striker << " hits a boundary!" << endl;
-        } else if (runs == 6) {
-            cout << "SIX! " << striker << " hits it out of the park!" << endl;
-        }
+        start = chrono::steady_clock::now();
+        BallQuery::Aggregate indexed = BallBitmapIndex::aggregate(index.select(query.predicates), columns);
+        double indexSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
         
-        cout << "Score: " << totalRuns << "/" << totalWickets << " (" 
-             << totalOvers << "." << currentOverBalls << ")" << endl << endl;
+        cout << "Bitmap index: " << indexSeconds * 1e3 << " ms (built in " << buildSeconds * 1e3 << " ms, "
+             << index.sizeInBytes() / 1024 << " KB)";
+        if (indexed.balls != result.total.balls || indexed.runs != result.total.runs) cout << " | MISMATCH";
+        cout << endl;
     }
-};
+    return 0;
+}
 
-// Match class
-class Match {
-private:
-    Team* team1;
-    Team* team2;
-    unique_ptr<Innings> innings1;
-    unique_ptr<Innings> innings2;
+// Summarise a packed archive written with --archive
+int scanArchive(const string& path) {
+    auto start = chrono::steady_clock::now();
+    ArchiveSummary summary;
+    if (!PackedArchive::scanFile(path, summary)) {
+        cerr << "Cannot read archive " << path << endl;
+        return 1;
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
     
-    MatchResult result;
-    shared_ptr<Player> playerOfMatch;
-    string venue;
-    string date;
+    cout << "Innings: " << summary.innings << " | Balls: " << summary.balls
+         << " | Runs: " << summary.runs << " | Wickets: " << summary.wickets << endl;
+    cout << "Fours: " << summary.fours << " | Sixes: " << summary.sixes
+         << " | Highest innings: " << summary.highestScore << endl;
+    cout << "Scanned in " << fixed << setprecision(3) << seconds << " s ("
+         << setprecision(1) << summary.innings * sizeof(uint64_t) / seconds / 1e6 << " MB/s)" << endl;
+    return 0;
+}
+
+// Odds from a given score, e.g. "14/1@1.3"; with --chasing the score is the
+// second innings and the argument is the first-innings total
+int whatIfAnalysis(const RunOptions& options) {
+    int runs, wickets, overs, overBalls;
+    if (sscanf(options.whatIf.c_str(), "%d/%d@%d.%d", &runs, &wickets, &overs, &overBalls) != 4 ||
+        runs < 0 || runs > 1000 || wickets < 0 || wickets > 2 || overs < 0 || overs > 2 ||
+        overBalls < 0 || overBalls > 5 || options.chasing > 1000) {
+        cerr << "Expected RUNS/WICKETS@OVERS.BALLS, got " << options.whatIf << endl;
+        return 1;
+    }
     
-public:
-    Match(Team* t1, Team* t2, const string& v, const string& d) : 
-        team1(t1), team2(t2), venue(v), date(d) {
-        innings1 = make_unique<Innings>(team1, team2);
-        innings2 = make_unique<Innings>(team2, team1);
+    MatchState from;
+    InningsState current = InningsState::at(runs, wickets, overs, overBalls);
+    if (options.chasing >= 0) {
+        from.innings[0] = InningsState::at(options.chasing, 0, 2, 0);
+        from.innings[1] = current;
+    } else {
+        from.innings[0] = current;
+        from.innings[1] = InningsState::opening(5, 5);
     }
     
-    // Setup methods
-    void setupInnings() {
-        string striker, nonStriker, bowler;
-        
-        cout << "\n=== Setting up " << team1->getName() << " innings ===" << endl;
-        cout << "Enter striker name: ";
-        cin >> striker;
-        cout << "Enter non-striker name: ";
-        cin >> nonStriker;
-        cout << "Enter bowler name: ";
-        cin >> bowler;
-        
-        innings1->setBatsmen(striker, nonStriker);
-        innings1->setBowler(bowler);
-        
-        cout << "\n=== Setting up " << team2->getName() << " innings ===" << endl;
-        cout << "Enter striker name: ";
-        cin >> striker;
-        cout << "Enter non-striker name: ";
-        cin >> nonStriker;
-        cout << "Enter bowler name: ";
-        cin >> bowler;
-        
-        innings2->setBatsmen(striker, nonStriker);
-        innings2->setBowler(bowler);
+    uint64_t seed = options.seeded ? options.seed : random_device{}();
+    auto start = chrono::steady_clock::now();
+    WhatIfResult result = WhatIf::run(from, options.forks, options.threads, seed);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    
+    cout << "=== WHAT-IF: " << runs << "/" << wickets << " after " << overs << "." << overBalls << " overs, "
+         << (options.chasing >= 0 ? "chasing " + to_string(options.chasing) : string("first innings")) << " ===" << endl;
+    cout << "Forked " << result.forks << " continuations in " << fixed << setprecision(3) << seconds * 1e3
+         << " ms (" << options.threads << " threads, " << setprecision(1)
+         << result.forks / seconds / 1e6 << " M forks/s)" << endl;
+    
+    const vector<uint64_t>* totals[2] = {&result.firstTotals, &result.secondTotals};
+    const char* labels[2] = {"First innings total: ", "Second innings total:"};
+    for (int k = 0; k < 2; k++) {
+        cout << labels[k] << " mean " << result.mean(*totals[k])
+             << " | p10 " << result.percentile(*totals[k], 0.10)
+             << " | p50 " << result.percentile(*totals[k], 0.50)
+             << " | p90 " << result.percentile(*totals[k], 0.90) << endl;
+    }
+    
+    double n = result.forks ? (double)result.forks : 1;
+    cout << "Batting first wins: " << 100 * result.firstWins / n << "% | Batting second wins: "
+         << 100 * result.secondWins / n << "% | Tie: " << 100 * result.ties / n << "%" << endl;
+    return 0;
+}
+
+/*
+Scenario sweep over the rest of a season (fresh, or from --resume). SPEC is
+';'-separated scenarios of ','-separated FIXTURE=TEAM (1-based; TEAM 0 is a
+tie), e.g. "5=1;5=3;5=1,6=2". An unconstrained baseline is always first.
+*/
+int scenarioAnalysis(const RunOptions& options) {
+    Tournament tournament("IPL Mini Tournament");
+    tournament.setInteractive(false);
+    tournament.setVerbose(false);
+    if (!options.resumePath.empty()) {
+        if (!tournament.loadCheckpoint(options.resumePath)) {
+            cerr << "Cannot resume from checkpoint " << options.resumePath << endl;
+            return 1;
+        }
+    } else {
+        tournament.createTeams();
+        tournament.createDefaultPlayers();
+        tournament.generateFixtures();
     }
     
-    // Match execution
-    void playMatch() {
-        cout << "\n=== " << team1->getName() << " vs " << team2->getName() << " ===" << endl;
-        cout << "Venue: " << venue << " | Date: " << date << endl << endl;
-        
-        // First innings
-        cout << "=== FIRST INNINGS: " << team1->getName() << " batting ===" << endl;
-        while (!innings1->isInningsComplete()) {
-            innings1->playBall();
+    ScenarioEngine engine;
+    engine.load(tournament);
+    engine.addScenario({"baseline", {}});
+    
+    stringstream specs(options.scenarios);
+    string spec;
+    while (getline(specs, spec, ';')) {
+        Scenario scenario{spec, {}};
+        stringstream terms(spec);
+        string term;
+        int fixture, team;
+        while (getline(terms, term, ',')) {
+            if (sscanf(term.c_str(), "%d=%d", &fixture, &team) != 2) {
+                cerr << "Expected FIXTURE=TEAM, got " << term << endl;
+                return 1;
+            }
+            scenario.forced.push_back({fixture - 1, team - 1});
         }
-        
-        cout << "First innings complete! " << team1->getName() << " scored " 
-             << innings1->getTotalRuns() << "/" << innings1->getTotalWickets() << endl << endl;
-        
-        // Second innings
-        cout << "=== SECOND INNINGS: " << team2->getName() << " batting ===" << endl;
-        while (!innings2->isInningsComplete()) {
-            innings2->playBall();
+        if (!engine.addScenario(scenario)) {
+            cerr << "Scenario " << spec << " forces a played fixture or a team not in it" << endl;
+            return 1;
         }
-        
-        cout << "Second innings complete! " << team2->getName() << " scored " 
-             << innings2->getTotalRuns() << "/" << innings2->getTotalWickets() << endl << endl;
-        
-        determineResult();
-        playerOfMatch = calculatePlayerOfMatch();
-        printMatchSummary();
     }
     
-    void determineResult() {
-        int score1 = innings1->getTotalRuns();
-        int score2 = innings2->getTotalRuns();
-        
-        if (score1 > score2) {
-            result = MatchResult::WIN;
-            team1->updateMatchResult(MatchResult::WIN);
-            team2->updateMatchResult(MatchResult::LOSS);
-            team1->addPoints(2);
-        } else if (score2 > score1) {
-            result = MatchResult::LOSS;
-            team1->updateMatchResult(MatchResult::LOSS);
-            team2->updateMatchResult(MatchResult::WIN);
-            team2->addPoints(2);
-        } else {
-            result = MatchResult::TIE;
-            team1->updateMatchResult(MatchResult::TIE);
-            team2->updateMatchResult(MatchResult::TIE);
-            team1->addPoints(1);
-            team2->addPoints(1);
+    uint64_t seed = options.seeded ? options.seed : random_device{}();
+    auto start = chrono::steady_clock::now();
+    ScenarioEngine::Result result = engine.run(options.monteCarloRuns, seed);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    start = chrono::steady_clock::now();
+    ScenarioEngine::Result naive = engine.runNaive(options.monteCarloRuns, seed);
+    double naiveSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    
+    cout << "=== SCENARIOS: " << result.runs << " runs from fixture " << (engine.getPlayed() + 1)
+         << " of " << engine.getFixtureCount() << ", shared prefix to fixture " << engine.prefixEnd() << " ===" << endl;
+    for (int i = engine.prefixEnd(); i < (int)engine.getFixtureCount(); i++) {
+        cout << "Fixture " << (i + 1) << ": " << engine.describeFixture(i) << endl;
+    }
+    
+    cout << endl << left << setw(16) << "Scenario" << right;
+    for (const auto& name : engine.getTeamNames()) cout << setw(24) << name;
+    cout << endl << fixed << setprecision(1);
+    for (size_t s = 0; s < engine.getScenarios().size(); s++) {
+        cout << left << setw(16) << engine.getScenarios()[s].label << right;
+        for (uint64_t titles : result.champions[s]) {
+            cout << setw(23) << 100.0 * titles / max<uint64_t>(1, result.runs) << "%";
         }
+        cout << endl;
     }
     
-    shared_ptr<Player> calculatePlayerOfMatch() {
-        auto player1 = innings1->getPlayerOfInnings();
-        auto player2 = innings2->getPlayerOfInnings();
-        
-        if (player1->getMatchCredits() > player2->getMatchCredits()) {
-            return player1;
-        } else {
-            return player2;
+    cout << "\nPrefix reuse: " << setprecision(3) << seconds * 1e3 << " ms, " << result.simulated
+         << " matches | Full replay: " << naiveSeconds * 1e3 << " ms, " << naive.simulated << " matches" << endl;
+    return 0;
+}
+
+void printLiveTable(const LiveOdds& odds) {
+    cout << setw(10) << "Team" << setw(8) << "Points" << setw(10) << "Title" << setw(10) << "Top 4" << endl;
+    for (int t = 0; t < odds.getTeamCount(); t++) {
+        cout << setw(10) << "Team " + to_string(t + 1) << setw(8) << odds.getPoints(t)
+             << setw(9) << odds.titleOdds(t) << "%" << setw(9) << odds.qualifyOdds(t) << "%" << endl;
+    }
+}
+
+/*
+Live odds from a ball feed: a file, a named pipe, or "-" for stdin. One
+delivery per line (0, 1, 2, 3, 4, 6 or W); '#' starts a comment. Match
+boundaries follow from the innings rules, so the feed is just outcomes.
+*/
+int liveOdds(const RunOptions& options) {
+    ifstream file;
+    if (options.livePath != "-") {
+        file.open(options.livePath);
+        if (!file) {
+            cerr << "Cannot read ball feed " << options.livePath << endl;
+            return 1;
         }
     }
+    istream& feed = options.livePath == "-" ? cin : file;
     
-    // Getters
-    MatchResult getResult() const { return result; }
-    shared_ptr<Player> getPlayerOfMatch() const { return playerOfMatch; }
+    uint64_t seed = options.seeded ? options.seed : random_device{}();
+    auto start = chrono::steady_clock::now();
+    LiveOdds odds(options.leagueTeams, options.leagueMatches, options.monteCarloRuns, seed);
+    odds.update();
+    double setupMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
     
-    Team* getWinner() const {
-        if (result == MatchResult::WIN) return team1;
-        else if (result == MatchResult::LOSS) return team2;
-        return nullptr;  // Tie or no result
-    }
+    cout << fixed << setprecision(1);
+    cout << "=== LIVE ODDS: " << odds.getTeamCount() << " teams, " << odds.getFixtureCount() << " matches, "
+         << options.monteCarloRuns << " runs (setup " << setupMs << " ms) ===" << endl;
+    printLiveTable(odds);
     
-    // Summary
-    void printMatchSummary() {
-        cout << "\n=== MATCH SUMMARY ===" << endl;
-        cout << team1->getName() << ": " << innings1->getTotalRuns() << "/" << innings1->getTotalWickets() << endl;
-        cout << team2->getName() << ": " << innings2->getTotalRuns() << "/" << innings2->getTotalWickets() << endl;
+    vector<double> latencies;
+    string line;
+    while (getline(feed, line)) {
+        line = line.substr(0, line.find('#'));
+        line.erase(remove_if(line.begin(), line.end(), [](char c) { return isspace((unsigned char)c); }), line.end());
+        if (line.empty()) continue;
         
-        if (result == MatchResult::WIN) {
-            cout << "Result: " << team1->getName() << " won!" << endl;
-        } else if (result == MatchResult::LOSS) {
-            cout << "Result: " << team2->getName() << " won!" << endl;
-        } else {
-            cout << "Result: Match tied!" << endl;
+        int outcome = -1;
+        if (line == "W" || line == "w") outcome = 5;  // raw wicket
+        else if (line.size() == 1 && line[0] >= '0' && line[0] <= '6' && line[0] != '5') outcome = line[0] - '0';
+        if (outcome < 0) {
+            cerr << "Skipping bad delivery '" << line << "'" << endl;
+            continue;
+        }
+        if (odds.isSeasonOver()) {
+            cerr << "Season over; ignoring delivery" << endl;
+            continue;
+        }
+        
+        size_t match = odds.getLive();
+        auto received = chrono::steady_clock::now();
+        bool finished = odds.ball(outcome);
+        odds.update();
+        latencies.push_back(chrono::duration<double, milli>(chrono::steady_clock::now() - received).count());
+        
+        const MatchState& m = odds.getState();
+        const InningsState& innings = m.innings[0].isComplete() ? m.innings[1] : m.innings[0];
+        int leader = 0;
+        for (int t = 1; t < odds.getTeamCount(); t++) {
+            if (odds.titleOdds(t) > odds.titleOdds(leader)) leader = t;
         }
+        cout << "Match " << (match + 1) << " ";
+        if (finished) cout << "complete";
+        else cout << (int)innings.overs << "." << (int)innings.overBalls << " " << innings.runs << "/" << (int)innings.wickets;
+        cout << " | Favourite: Team " << (leader + 1) << " " << odds.titleOdds(leader) << "% | "
+             << setprecision(3) << latencies.back() << " ms" << setprecision(1) << endl;
         
-        cout << "Player of the Match: " << playerOfMatch->getName() << endl;
-        cout << "=========================================" << endl << endl;
+        if (finished) printLiveTable(odds);
     }
-};
+    
+    if (!latencies.empty()) {
+        sort(latencies.begin(), latencies.end());
+        auto at = [&](double q) { return latencies[min(latencies.size() - 1, (size_t)(q * latencies.size()))]; };
+        cout << setprecision(3) << "Updates: " << latencies.size() << " | p50 " << at(0.50) << " ms | p99 "
+             << at(0.99) << " ms | max " << latencies.back() << " ms" << endl;
+    }
+    return 0;
+}
 
-// Tournament class
-class Tournament {
+#if defined(__cpp_impl_coroutine)
+// Per-thread ball counts for a match day; checks that every match bowls
+// its k-th ball in tick k
+class MatchDayMonitor : public EventSubscriber {
 private:
-    string name;
-    vector<shared_ptr<Team>> teams;
-    vector<unique_ptr<Match>> matches;
-    vector<shared_ptr<Player>> allPlayers;
-    
-    int currentRound;
-    bool isCompleted;
+    vector<uint32_t>& ballsByMatch;
     
 public:
-    Tournament(const string& n) : name(n), currentRound(0), isCompleted(false) {}
+    uint64_t tick = 0;
+    uint64_t balls = 0;
+    uint64_t runs = 0;
+    uint64_t outOfOrder = 0;
     
-    // Tournament management
-    void addTeam(shared_ptr<Team> team) {
-        teams.push_back(team);
+    explicit MatchDayMonitor(vector<uint32_t>& counts) : ballsByMatch(counts) {}
+    
+    void onEvent(const GameEvent& e) override {
+        if (e.kind != GameEvent::BALL) return;
+        balls++;
+        runs += runsFor((BallOutcome)e.outcome);
+        if (++ballsByMatch[e.matchId] != tick + 1) outOfOrder++;
     }
+};
+#endif
+
+/*
+Simulated match day: N independent fixtures (2N generated teams) bowled
+ball by ball in lock-step on --threads workers, then the same fixtures
+played one after another for comparison. Needs a C++20 build.
+*/
+int runMatchDay(const RunOptions& options) {
+#if defined(__cpp_impl_coroutine)
+    size_t count = (size_t)options.matchDay;
+    unsigned threads = max(1u, min<unsigned>(options.threads, (unsigned)count));
+    const PlayerType roles[] = {PlayerType::BATSMAN, PlayerType::BATSMAN, PlayerType::BOWLER,
+                                PlayerType::ALLROUNDER, PlayerType::BOWLER};
     
-    void generateFixtures() {
-        // Round-robin: each team plays every other team
-        for (int i = 0; i < teams.size(); i++) {
-            for (int j = i + 1; j < teams.size(); j++) {
-                auto match = make_unique<Match>(teams[i].get(), teams[j].get(), "Home Ground", "Today");
-                matches.push_back(move(match));
+    // Two copies of the day: one interleaved, one sequential
+    PlayerPool players;
+    vector<shared_ptr<Team>> teams;
+    Arena arena;
+    vector<Match*> matches;
+    vector<mt19937> generators;
+    generators.reserve(2 * count);
+    for (int copy = 0; copy < 2; copy++) {
+        for (size_t m = 0; m < count; m++) {
+            for (int side = 0; side < 2; side++) {
+                size_t t = 2 * m + side;
+                auto team = make_shared<Team>("Team " + to_string(t + 1), "City");
+                for (int i = 0; i < 5; i++) {
+                    string name = "T" + to_string(t + 1) + "P" + to_string(i + 1);
+                    team->addPlayer(players.make(roles[i], name, 25));
+                }
+                team->selectPlaying5();
+                teams.push_back(team);
             }
+            Match* match = arena.make<Match>(teams[teams.size() - 2].get(), teams.back().get(), "Home Ground", "Today");
+            match->setMatchId((uint32_t)m);
+            generators.emplace_back((options.seeded ? options.seed : 0) + (uint32_t)m);
+            match->setRandom(&generators.back());
+            matches.push_back(match);
         }
     }
     
-    void playRound() {
-        if (currentRound < matches.size()) {
-            cout << "\n=== ROUND " << (currentRound + 1) << " ===" << endl;
-            matches[currentRound]->setupInnings();
-            matches[currentRound]->playMatch();
-            currentRound++;
-        }
-    }
+    vector<uint32_t> ballsByMatch(count);
+    vector<EventBus> buses(threads);
+    vector<MatchDayMonitor> monitors(threads, MatchDayMonitor(ballsByMatch));
+    for (unsigned t = 0; t < threads; t++) buses[t].subscribe(&monitors[t]);
     
-    void playTournament() {
-        cout << "\n=== TOURNAMENT BEGINS ===" << endl;
-        for (int i = 0; i < matches.size(); i++) {
-            playRound();
-        }
-        isCompleted = true;
+    // Each match publishes to the bus of the worker that bowls it
+    MatchDay day;
+    for (unsigned t = 0; t < threads; t++) {
+        size_t last = MatchDay::firstTask(count, t + 1, threads);
+        for (size_t m = MatchDay::firstTask(count, t, threads); m < last; m++) matches[m]->attachBus(&buses[t]);
     }
+    for (size_t m = 0; m < count; m++) day.add(matches[m]->play());
     
-    // User input methods
-    void createTeams() {
-        string teamNames[] = {"Mumbai Indians", "Chennai Super Kings", "Royal Challengers", "Kolkata Knight Riders"};
-        string cities[] = {"Mumbai", "Chennai", "Bangalore", "Kolkata"};
-        
-        for (int i = 0; i < 4; i++) {
-            auto team = make_shared<Team>(teamNames[i], cities[i]);
-            addTeam(team);
-        }
-    }
+    auto start = chrono::steady_clock::now();
+    uint64_t ticks = day.run(threads, [&](unsigned t, uint64_t tick) { monitors[t].tick = tick; });
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
     
-    void createPlayers() {
-        // Create players for each team
-        for (auto& team : teams) {
-            cout << "\nCreating players for " << team->getName() << ":" << endl;
-            
-            for (int i = 0; i < 5; i++) {
-                string name, typeStr;
-                int age, typeChoice;
-                
-                cout << "Player " << (i + 1) << " name: ";
-                cin >> name;
-                cout << "Player " << (i + 1) << " age: ";
-                cin >> age;
-                cout << "Player " << (i + 1) << " type (1-Batsman, 2-Bowler, 3-AllRounder): ";
-                cin >> typeChoice;
-                
-                shared_ptr<Player> player;
-                switch (typeChoice) {
-                    case 1: player = make_shared<Batsman>(name, age); break;
-                    case 2: player = make_shared<Bowler>(name, age); break;
-                    case 3: player = make_shared<AllRounder>(name, age); break;
-                    default: player = make_shared<Batsman>(name, age); break;
-                }
-                
-                team->addPlayer(player);
-                allPlayers.push_back(player);
-            }
-            
-            team->selectPlaying5();
-        }
+    start = chrono::steady_clock::now();
+    for (size_t m = count; m < 2 * count; m++) matches[m]->playMatch();
+    double sequentialSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    
+    uint64_t balls = 0, runs = 0, outOfOrder = 0;
+    for (const auto& monitor : monitors) {
+        balls += monitor.balls;
+        runs += monitor.runs;
+        outOfOrder += monitor.outOfOrder;
+    }
+    bool same = true;
+    for (size_t m = 0; m < count; m++) {
+        same = same && matches[m]->getResult() == matches[m + count]->getResult() &&
+               matches[m]->getFirstInnings().getTotalRuns() == matches[m + count]->getFirstInnings().getTotalRuns() &&
+               matches[m]->getSecondInnings().getTotalRuns() == matches[m + count]->getSecondInnings().getTotalRuns();
     }
     
-    // Statistics and results
-    vector<shared_ptr<Team>> getPointsTable() const {
-        auto sortedTeams = teams;
-        sort(sortedTeams.begin(), sortedTeams.end(), 
-             [](const auto& a, const auto& b) { return a->getPoints() > b->getPoints(); });
-        return sortedTeams;
+    cout << "=== MATCH DAY: " << count << " matches on " << threads << " threads ===" << endl;
+    cout << "Ticks: " << ticks << " | Balls: " << balls << " | Runs: " << runs
+         << " | Out-of-order balls: " << outOfOrder << endl;
+    cout << "Interleaved: " << fixed << setprecision(3) << seconds * 1e3 << " ms ("
+         << setprecision(1) << balls / seconds / 1e6 << " M balls/s) | Sequential: "
+         << setprecision(3) << sequentialSeconds * 1e3 << " ms | Results match: " << (same ? "yes" : "no") << endl;
+    return 0;
+#else
+    (void)options;
+    cerr << "Match days need a C++20 build (coroutines)" << endl;
+    return 1;
+#endif
+}
+
+// Stream batch seasons to subscribers; the simulation runs on its own thread
+int serveScores(const RunOptions& options) {
+#if defined(__linux__)
+    ScoreServer server;
+    if (!server.listenOn(options.serveAddress)) {
+        cerr << "Cannot listen on " << options.serveAddress << " (expected unix:PATH or tcp:PORT)" << endl;
+        return 1;
     }
+    cout << "Serving scores on " << options.serveAddress;
+    if (options.subscribers > 0) cout << ", waiting for " << options.subscribers << " subscribers";
+    cout << endl;
     
-    shared_ptr<Player> getPlayerOfTournament() const {
-        shared_ptr<Player> bestPlayer = nullptr;
-        int maxCredits = -1;
-        
-        for (const auto& player : allPlayers) {
-            if (player->getTotalCredits() > maxCredits) {
-                maxCredits = player->getTotalCredits();
-                bestPlayer = player;
+    ScoreStream stream;
+    atomic<bool> start(options.subscribers == 0);
+    uint64_t matches = 0;
+    thread simulation([&] {
+        while (!start.load(memory_order_acquire)) this_thread::sleep_for(chrono::milliseconds(1));
+        for (int s = 0; s < max(1, options.seasons); s++) {
+            Tournament tournament("IPL Mini Tournament");
+            tournament.setInteractive(false);
+            tournament.setVerbose(false);
+            if (options.seeded) tournament.setSeed(options.seed + s);
+            tournament.attachBallLog(nullptr, (uint32_t)matches);
+            tournament.attachStream(&stream);
+            tournament.createTeams();
+            tournament.createDefaultPlayers();
+            tournament.generateFixtures();
+            for (size_t m = 0; m < tournament.getMatchCount(); m++) {
+                tournament.playRound();
+                if (options.paceMs > 0) this_thread::sleep_for(chrono::milliseconds(options.paceMs));
             }
+            matches += tournament.getMatchCount();
         }
-        
-        return bestPlayer;
-    }
+        stream.finish();
+    });
     
-    shared_ptr<Team> getChampion() const {
-        auto pointsTable = getPointsTable();
-        return pointsTable.empty() ? nullptr : pointsTable[0];
-    }
+    auto begin = chrono::steady_clock::now();
+    server.run(stream, options.subscribers, start);
+    simulation.join();
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
     
-    // Getters
-    string getName() const { return name; }
-    bool getIsCompleted() const { return isCompleted; }
+    cout << "Streamed " << matches << " matches in " << fixed << setprecision(3) << seconds << " s | Clients: "
+         << server.getAccepted() << " | Events delivered: " << server.getEventsSent()
+         << " | Bytes: " << server.getBytesSent() << endl;
+    cout << "Dropped at ring: " << stream.getDropped() << " | Slow clients disconnected: "
+         << server.getSlowDisconnects() << endl;
+    return 0;
+#else
+    cerr << "Score server needs epoll (Linux)" << endl;
+    return 1;
+#endif
+}
+
+// Main function to demonstrate the system
+void printUsage(ostream& out) {
+    out << "Usage: tournament [options]\n"
+           "With no mode option the tournament is set up and played interactively.\n"
+           "\n"
+           "Play:\n"
+           "  --auto                    generated rosters instead of prompts\n"
+           "  --seed N                  seed the simulation (season s uses N+s in batch modes)\n"
+           "  --varied-commentary       vary the ball commentary phrasing\n"
+           "  --checkpoint FILE         write a checkpoint after every round\n"
+           "  --resume FILE             continue from a checkpoint\n"
+           "  --seasons N               batch mode: play N seasons without commentary\n"
+           "  --threads N               worker threads for parallel modes\n"
+           "\n"
+           "Outputs (interactive or --seasons):\n"
+           "  --ball-log FILE           binary log of every delivery\n"
+           "  --archive FILE            packed per-innings archive\n"
+           "  --career DIR              accumulate career totals in a career store\n"
+           "  --export DIR              CSV and columnar tables of the (last) tournament\n"
+           "  --commentary-file FILE    write full commentary of --seasons N to FILE\n"
+           "\n"
+           "Logs and archives:\n"
+           "  --replay LOG K            replay the K-th logged match\n"
+           "  --query LOG               aggregate totals over a ball log\n"
+           "  --export-balls LOG DIR    ball table of a log as CSV and columnar files\n"
+           "  --analyze LOG FILTER      filtered totals; FILTER is col=value,... or all\n"
+           "  --group COLUMN            group --analyze results by a column\n"
+           "  --index                   use the bitmap index for --analyze\n"
+           "  --scan-archive FILE       summarise a packed archive\n"
+           "\n"
+           "Odds and scenarios:\n"
+           "  --what-if SCORE           win odds from a score such as 14/1@1.3\n"
+           "  --chasing TARGET          treat --what-if as the second innings\n"
+           "  --forks N                 simulations per --what-if (default 100000)\n"
+           "  --scenarios SPEC          season scenario sweep, e.g. \"5=1;5=3\"\n"
+           "  --runs N                  Monte Carlo runs (default 10000)\n"
+           "  --live FEED               live odds from a ball feed (file, pipe or -)\n"
+           "  --league TEAMS MATCHES    league shape for --live (default 10 70)\n"
+           "\n"
+           "Match day and streaming:\n"
+           "  --match-day N             N fixtures bowled in lock-step (C++20 builds)\n"
+           "  --serve ADDRESS           stream scores on unix:PATH or tcp:PORT\n"
+           "  --subscribers N           wait for N subscribers before streaming\n"
+           "  --pace MS                 delay between streamed balls\n"
+           "\n"
+           "Diagnostics:\n"
+           "  --stats                   print runtime counters on exit\n"
+           "  --trace FILE              write a Chrome trace\n"
+           "  --profile                 hardware counters around batch seasons (Linux)\n"
+           "  --bench                   ball-loop benchmark\n"
+           "  --alloc-check N           fail if any match allocates more than N times\n";
+}
+
+// Tests build this file with TOURNAMENT_NO_MAIN and drive the classes directly
+#ifndef TOURNAMENT_NO_MAIN
+int main(int argc, char* argv[]) {
+    RunOptions options;
     
-    // Display methods
-    void displayTeams() {
-        cout << "\n=== TOURNAMENT TEAMS ===" << endl;
-        for (const auto& team : teams) {
-            cout << team->getName() << " (" << team->getPlaying5().size() << " players)" << endl;
+    // Numeric option values; a malformed one ends the run with the usage text
+    bool valid = true;
+    auto intArg = [&](const char* text) {
+        int value = 0;
+        if (!parseNumber(text, value)) {
+            cerr << "Invalid number: " << text << endl;
+            valid = false;
         }
-        cout << "=========================" << endl;
-    }
+        return value;
+    };
+    auto uintArg = [&](const char* text) {
+        uint64_t value = 0;
+        if (!parseNumber(text, value)) {
+            cerr << "Invalid number: " << text << endl;
+            valid = false;
+        }
+        return value;
+    };
     
-    void displayPlayerStats() {
-        cout << "\n=== FINAL PLAYER STATISTICS ===" << endl;
-        cout << setw(20) << "Name" << setw(10) << "Runs" << setw(10) << "Balls" << setw(10) << "Wickets" << setw(10) << "Credits" << endl;
-        cout << "------------------------------------------------------------" << endl;
-        
-        for (const auto& player : allPlayers) {
-            cout << setw(20) << player->getName() 
-                 << setw(10) << player->getTotalRunsScored()
-                 << setw(10) << player->getTotalBallsFaced()
-                 << setw(10) << player->getTotalWicketsTaken()
-                 << setw(10) << player->getTotalCredits() << endl;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--ball-log" && i + 1 < argc) options.ballLogPath = argv[++i];
+        else if (arg == "--archive" && i + 1 < argc) options.archivePath = argv[++i];
+        else if (arg == "--scan-archive" && i + 1 < argc) options.scanPath = argv[++i];
+        else if (arg == "--seasons" && i + 1 < argc) options.seasons = intArg(argv[++i]);
+        else if (arg == "--query" && i + 1 < argc) options.queryPath = argv[++i];
+        else if (arg == "--export" && i + 1 < argc) options.exportDir = argv[++i];
+        else if (arg == "--career" && i + 1 < argc) options.careerDir = argv[++i];
+        else if (arg == "--checkpoint" && i + 1 < argc) options.checkpointPath = argv[++i];
+        else if (arg == "--resume" && i + 1 < argc) options.resumePath = argv[++i];
+        else if (arg == "--auto") options.autoPlayers = true;
+        else if (arg == "--varied-commentary") options.variedCommentary = true;
+        else if (arg == "--seed" && i + 1 < argc) {
+            options.seeded = true;
+            options.seed = (uint32_t)uintArg(argv[++i]);
         }
-        
-        cout << "\n=== FINAL POINTS TABLE ===" << endl;
-        auto pointsTable = getPointsTable();
-        for (int i = 0; i < pointsTable.size(); i++) {
-            cout << (i + 1) << ". " << setw(25) << pointsTable[i]->getName() 
-                 << " - " << pointsTable[i]->getPoints() << " points" << endl;
+        else if (arg == "--replay" && i + 2 < argc) {
+            options.replayPath = argv[++i];
+            options.replayIndex = uintArg(argv[++i]);
+        } else if (arg == "--analyze" && i + 2 < argc) {
+            options.analyzePath = argv[++i];
+            options.analyzeFilter = argv[++i];
+        } else if (arg == "--group" && i + 1 < argc) {
+            options.groupBy = argv[++i];
+        } else if (arg == "--index") {
+            options.useIndex = true;
+        } else if (arg == "--threads" && i + 1 < argc) {
+            options.threads = (unsigned)max(1, intArg(argv[++i]));
+        } else if (arg == "--export-balls" && i + 2 < argc) {
+            options.exportBallsPath = argv[++i];
+            options.exportDir = argv[++i];
+        } else if (arg == "--what-if" && i + 1 < argc) {
+            options.whatIf = argv[++i];
+        } else if (arg == "--chasing" && i + 1 < argc) {
+            options.chasing = intArg(argv[++i]);
+        } else if (arg == "--forks" && i + 1 < argc) {
+            options.forks = max<uint64_t>(1, uintArg(argv[++i]));
+        } else if (arg == "--scenarios" && i + 1 < argc) {
+            options.scenarios = argv[++i];
+        } else if (arg == "--trace" && i + 1 < argc) {
+            options.tracePath = argv[++i];
+        } else if (arg == "--commentary-file" && i + 1 < argc) {
+            options.commentaryPath = argv[++i];
+        } else if (arg == "--alloc-check" && i + 1 < argc) {
+            options.allocationBudget = max(0, intArg(argv[++i]));
+        } else if (arg == "--bench") {
+            options.bench = true;
+        } else if (arg == "--profile") {
+            options.profile = true;
+        } else if (arg == "--stats") {
+            options.stats = true;
+        } else if (arg == "--match-day" && i + 1 < argc) {
+            options.matchDay = max(1, intArg(argv[++i]));
+        } else if (arg == "--serve" && i + 1 < argc) {
+            options.serveAddress = argv[++i];
+        } else if (arg == "--subscribers" && i + 1 < argc) {
+            options.subscribers = (size_t)max(0, intArg(argv[++i]));
+        } else if (arg == "--pace" && i + 1 < argc) {
+            options.paceMs = max(0, intArg(argv[++i]));
+        } else if (arg == "--live" && i + 1 < argc) {
+            options.livePath = argv[++i];
+        } else if (arg == "--league" && i + 2 < argc) {
+            options.leagueTeams = max(2, intArg(argv[++i]));
+            options.leagueMatches = max(1, intArg(argv[++i]));
+        } else if (arg == "--runs" && i + 1 < argc) {
+            options.monteCarloRuns = max<uint64_t>(1, uintArg(argv[++i]));
+        } else if (arg == "--help" || arg == "-h") {
+            printUsage(cout);
+            return 0;
+        } else {
+            cerr << "Unknown option or missing value: " << arg << endl;
+            valid = false;
         }
-        
-        auto champion = getChampion();
-        auto playerOfTournament = getPlayerOfTournament();
-        
-        cout << "\n=== TOURNAMENT AWARDS ===" << endl;
-        cout << "Champion: " << champion->getName() << endl;
-        cout << "Player of the Tournament: " << playerOfTournament->getName() << endl;
     }
-};
-
-// Statistics and utility classes
-class Statistics {
-public:
-    static shared_ptr<Player> getPlayerOfMatch(const vector<shared_ptr<Player>>& players) {
-        shared_ptr<Player> bestPlayer = nullptr;
-        int maxCredits = -1;
-        
-        for (const auto& player : players) {
-            if (player->getMatchCredits() > maxCredits) {
-                maxCredits = player->getMatchCredits();
-                bestPlayer = player;
-            }
-        }
-        
-        return bestPlayer;
+    if (!valid) {
+        printUsage(cerr);
+        return 1;
     }
     
-    static shared_ptr<Player> getPlayerOfTournament(const vector<shared_ptr<Player>>& players) {
-        shared_ptr<Player> bestPlayer = nullptr;
-        int maxCredits = -1;
-        
-        for (const auto& player : players) {
-            if (player->getTotalCredits() > maxCredits) {
-                maxCredits = player->getTotalCredits();
-                bestPlayer = player;
-            }
+    // Counters are printed after whichever mode runs, on every exit path
+    if (options.stats) atexit([] { SimStats::print(cout); });
+    if (!options.tracePath.empty()) Tracer::start(options.tracePath);
+    
+    if (!options.scanPath.empty()) return scanArchive(options.scanPath);
+    if (!options.replayPath.empty()) return replayLoggedMatch(options.replayPath, options.replayIndex);
+    if (!options.queryPath.empty()) return queryBallLog(options.queryPath);
+    if (!options.exportBallsPath.empty()) return exportBallLog(options.exportBallsPath, options.exportDir);
+    if (!options.analyzePath.empty()) return analyzeBallLog(options);
+    if (!options.whatIf.empty()) return whatIfAnalysis(options);
+    if (!options.scenarios.empty()) return scenarioAnalysis(options);
+    if (!options.livePath.empty()) return liveOdds(options);
+    if (!options.serveAddress.empty()) return serveScores(options);
+    if (options.matchDay > 0) return runMatchDay(options);
+    if (!options.commentaryPath.empty()) return archiveCommentary(options);
+    
+    BallLog ballLog;
+    if (!options.ballLogPath.empty() && !ballLog.open(options.ballLogPath)) {
+        cerr << "Cannot open ball log " << options.ballLogPath << endl;
+        return 1;
+    }
+    BallLog* log = ballLog.isOpen() ? &ballLog : nullptr;
+    
+    PackedArchive archive;
+    if (!options.archivePath.empty() && !archive.open(options.archivePath)) {
+        cerr << "Cannot open archive " << options.archivePath << endl;
+        return 1;
+    }
+    
+    // Output files are closed explicitly so a failed final write is reported
+    auto closeOutputs = [&]() {
+        bool ok = true;
+        if (!ballLog.close()) {
+            cerr << "Cannot write ball log " << options.ballLogPath << endl;
+            ok = false;
         }
-        
-        return bestPlayer;
+        if (!archive.close()) {
+            cerr << "Cannot write archive " << options.archivePath << endl;
+            ok = false;
+        }
+        return ok;
+    };
+    
+    CareerStore careerStore;
+    CareerStore* careers = nullptr;
+    if (!options.careerDir.empty()) {
+        auto start = chrono::steady_clock::now();
+        if (!careerStore.open(options.careerDir)) {
+            cerr << "Cannot open career store " << options.careerDir << endl;
+            return 1;
+        }
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        cout << "Loaded " << careerStore.size() << " player careers in " << fixed << setprecision(3)
+             << ms << " ms" << endl;
+        cout.unsetf(ios::floatfield);
+        careers = &careerStore;
     }
     
-    static vector<shared_ptr<Team>> sortTeamsByPoints(const vector<shared_ptr<Team>>& teams) {
-        auto sortedTeams = teams;
-        sort(sortedTeams.begin(), sortedTeams.end(), 
-             [](const auto& a, const auto& b) { return a->getPoints() > b->getPoints(); });
-        return sortedTeams;
+    if (options.profile) return profileSeasons(options);
+    if (options.bench) return benchmarkBallLoop(options);
+    if (options.allocationBudget >= 0) {
+        int status = checkAllocations(options, log);
+        return closeOutputs() ? status : 1;
     }
-};
-
-// Main function to demonstrate the system
-int main() {
+    if (options.seasons > 0) {
+        int status = runSeasons(options, log, archive.isOpen() ? &archive : nullptr, careers);
+        return closeOutputs() ? status : 1;
+    }
+    
     cout << "=== IPL-like Tournament System (Simplified) ===" << endl;
     cout << "4 teams, 5 players each, 2 overs, 2 wickets" << endl << endl;
     
     // Create tournament
     Tournament tournament("IPL Mini Tournament");
+    if (options.seeded) tournament.setSeed(options.seed);
+    tournament.setVariedCommentary(options.variedCommentary);
+    tournament.attachBallLog(log, 0);
+    tournament.attachArchive(archive.isOpen() ? &archive : nullptr);
+    tournament.setCheckpointPath(options.checkpointPath);
     
-    // User creates teams and players
-    tournament.createTeams();
-    tournament.createPlayers();
-    
-    // Display created teams
-    tournament.displayTeams();
+    if (!options.resumePath.empty()) {
+        if (!tournament.loadCheckpoint(options.resumePath)) {
+            cerr << "Cannot resume from checkpoint " << options.resumePath << endl;
+            return 1;
+        }
+    } else {
+        // User creates teams and players
+        tournament.createTeams();
+        if (options.autoPlayers) {
+            tournament.setInteractive(false);
+            tournament.createDefaultPlayers();
+        } else {
+            tournament.createPlayers();
+        }
+        
+        // Display created teams
+        tournament.displayTeams();
+        
+        // Generate matches
+        tournament.generateFixtures();
+    }
     
-    // Generate and play matches
-    tournament.generateFixtures();
     tournament.playTournament();
     
     // Display final results
     tournament.displayPlayerStats();
     
+    if (careers) {
+        if (!careers->recordTournament(tournament.getPlayers())) {
+            cerr << "Cannot write career store " << options.careerDir << endl;
+            return 1;
+        }
+        displayCareerStats(*careers, tournament.getPlayers());
+    }
+    
+    if (!options.exportDir.empty() && !StatsExporter::exportTournament(tournament, options.exportDir)) {
+        cerr << "Cannot export to " << options.exportDir << endl;
+        return 1;
+    }
+    
+    if (!closeOutputs()) return 1;
+    
     cout << "\nTournament completed successfully!" << endl;
     return 0;
-}
\ No newline at end of file
+}
+#endif